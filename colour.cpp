@@ -59,7 +59,7 @@ Colour::Colour(uint8_t _r, uint8_t _g, uint8_t _b) {
 }
 
 bool Colour::operator<(const Colour &c) const {
-    return this->r < c.r || this->g < c.g || this->b < c.b;
+    return std::tie(this->r, this->g, this->b) < std::tie(c.r, c.g, c.b);
 }
 
 
@@ -68,35 +68,27 @@ std::ostream &operator<<(std::ostream &os, const Colour &colour) {
 }
 
 float getColourAbsoluteDiff(const Colour &colour_1, const Colour &colour_2) {
-    int r = colour_1.r - colour_2.r;
-    int g = colour_1.g - colour_2.g;
-    int b = colour_1.b - colour_2.b;
-    // Take sqrt to convert squared distance to actual Euclidean distance;
-    // divide by sqrt(3) so max is 255 (when the diff is (255, 255, 255)).
-    return std::sqrt(float(r * r + g * g + b * b)) / std::sqrt(3.0f);
+    return colourDifference<COLOUR_METRIC_ABSOLUTE>(colour_1, colour_2);
 }
 
 float getColourHueDiff(const Colour &colour_1, const Colour &colour_2) {
-    // Underlying value is in [0, 2] (hue and lum both in [0, 1]);
-    // scale by 127.5 to hit [0, 255].
-    return std::fabs((colour_1.hue - colour_1.lum) - (colour_2.hue - colour_2.lum)) * 127.5f;
+    return colourDifference<COLOUR_METRIC_HUE>(colour_1, colour_2);
 }
 
 float getColourLuminosityDiff(const Colour &colour_1, const Colour &colour_2) {
-    // lum is in [0, 1], diff is in [0, 1], scale to [0, 255].
-    return std::fabs(colour_1.lum - colour_2.lum) * 255.0f;
+    return colourDifference<COLOUR_METRIC_LUMINOSITY>(colour_1, colour_2);
 }
 
 float getNaturalColourDiff(const Colour &colour_1, const Colour &colour_2) {
-    int rmean = (colour_1.r + colour_2.r) / 2;
-    int r = colour_1.r - colour_2.r;
-    int g = colour_1.g - colour_2.g;
-    int b = colour_1.b - colour_2.b;
-    float squared = float((((512 + rmean) * r * r) >> 8)
-                          + 4 * g * g
-                          + (((767 - rmean) * b * b) >> 8));
-    // sqrt to linear-perceptual, then scale. Empirical max is ~sqrt(650000) ≈ 806.
-    return std::sqrt(squared) / std::sqrt(650000.0f) * 255.0f;
+    return colourDifference<COLOUR_METRIC_NATURAL>(colour_1, colour_2);
+}
+
+ColourMetric getColourMetric(float (*func)(const Colour &, const Colour &)) {
+    if (func == getColourAbsoluteDiff) return COLOUR_METRIC_ABSOLUTE;
+    if (func == getNaturalColourDiff) return COLOUR_METRIC_NATURAL;
+    if (func == getColourHueDiff) return COLOUR_METRIC_HUE;
+    if (func == getColourLuminosityDiff) return COLOUR_METRIC_LUMINOSITY;
+    return COLOUR_METRIC_UNKNOWN;
 }
 
 bool compareHue(const Colour &c1, const Colour &c2) {
@@ -24,12 +24,104 @@ struct Colour {
 
     Colour(uint8_t _r, uint8_t _g, uint8_t _b);
 
+    /// Orders by red, then green, then blue: cube order.
     bool operator<(const Colour &c) const;
 
 };
 
 std::ostream &operator<<(std::ostream &os, const Colour &colour);
 
+/// The difference functions below, as a value rather than a function
+/// pointer. Search structures need to know which metric they're ranking by
+/// so they can bound it; the renderer still calls through the pointer.
+enum ColourMetric {
+    COLOUR_METRIC_ABSOLUTE,
+    COLOUR_METRIC_NATURAL,
+    COLOUR_METRIC_HUE,
+    COLOUR_METRIC_LUMINOSITY,
+    COLOUR_METRIC_UNKNOWN,
+};
+
+/// Maps one of the getColour*Diff function pointers to its ColourMetric.
+ColourMetric getColourMetric(float (*func)(const Colour &, const Colour &));
+
+/// The tail of getColourAbsoluteDiff: turns an integer squared RGB distance
+/// into the scaled float distance. Monotonic in `squared`, so a lower bound
+/// on the squared distance maps to a lower bound on the difference.
+inline float absoluteDiffFromSquared(int squared) {
+    // Take sqrt to convert squared distance to actual Euclidean distance;
+    // divide by sqrt(3) so max is 255 (when the diff is (255, 255, 255)).
+    return std::sqrt(float(squared)) / std::sqrt(3.0f);
+}
+
+/// The tail of getNaturalColourDiff, likewise monotonic in `squared`.
+inline float naturalDiffFromSquared(int squared) {
+    // sqrt to linear-perceptual, then scale. Empirical max is ~sqrt(650000) ≈ 806.
+    return std::sqrt(float(squared)) / std::sqrt(650000.0f) * 255.0f;
+}
+
+/// getColourHueDiff and getColourLuminosityDiff are both the absolute
+/// difference of one scalar per colour, scaled. These return that scalar,
+/// so sorted structures can order colours by it.
+inline float getColourHueKey(const Colour &colour) {
+    return colour.hue - colour.lum;
+}
+
+inline float getColourLuminosityKey(const Colour &colour) {
+    return colour.lum;
+}
+
+/// The body of each getColour*Diff function, picked at compile time so fill
+/// loops specialised on a metric can inline it.
+template<ColourMetric Metric>
+inline float colourDifference(const Colour &colour_1, const Colour &colour_2) {
+    static_assert(Metric != COLOUR_METRIC_UNKNOWN, "no difference function for COLOUR_METRIC_UNKNOWN");
+    if constexpr (Metric == COLOUR_METRIC_ABSOLUTE) {
+        const int r = colour_1.r - colour_2.r;
+        const int g = colour_1.g - colour_2.g;
+        const int b = colour_1.b - colour_2.b;
+        return absoluteDiffFromSquared(r * r + g * g + b * b);
+    } else if constexpr (Metric == COLOUR_METRIC_NATURAL) {
+        const int rmean = (colour_1.r + colour_2.r) / 2;
+        const int r = colour_1.r - colour_2.r;
+        const int g = colour_1.g - colour_2.g;
+        const int b = colour_1.b - colour_2.b;
+        return naturalDiffFromSquared((((512 + rmean) * r * r) >> 8)
+                                      + 4 * g * g
+                                      + (((767 - rmean) * b * b) >> 8));
+    } else if constexpr (Metric == COLOUR_METRIC_HUE) {
+        // Underlying value is in [0, 2] (hue and lum both in [0, 1]);
+        // scale by 127.5 to hit [0, 255].
+        return std::fabs(getColourHueKey(colour_1) - getColourHueKey(colour_2)) * 127.5f;
+    } else {
+        // lum is in [0, 1], diff is in [0, 1], scale to [0, 255].
+        return std::fabs(getColourLuminosityKey(colour_1) - getColourLuminosityKey(colour_2)) * 255.0f;
+    }
+}
+
+/// colourDifference<Metric> as a function object, for code templated on
+/// how it compares colours.
+template<ColourMetric Metric>
+struct ColourDifference {
+    static constexpr ColourMetric metric = Metric;
+
+    float operator()(const Colour &colour_1, const Colour &colour_2) const {
+        return colourDifference<Metric>(colour_1, colour_2);
+    }
+};
+
+/// The same, calling through a difference function pointer that isn't one
+/// of the four built-in metrics.
+struct ColourDifferenceFunction {
+    static constexpr ColourMetric metric = COLOUR_METRIC_UNKNOWN;
+
+    float (*function)(const Colour &, const Colour &);
+
+    float operator()(const Colour &colour_1, const Colour &colour_2) const {
+        return this->function(colour_1, colour_2);
+    }
+};
+
 float getColourAbsoluteDiff(const Colour &colour_1, const Colour &colour_2);
 
 float getColourHueDiff(const Colour &colour_1, const Colour &colour_2);
@@ -0,0 +1,505 @@
+#include "colour_batch.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RAINBOW_C_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/// The integer that getColourAbsoluteDiff or getNaturalColourDiff passes to
+/// its *DiffFromSquared tail, between the query (qr, qg, qb) and a candidate.
+template<ColourMetric Metric>
+inline int squaredKey(int qr, int qg, int qb, int r, int g, int b) {
+    const int dr = qr - r;
+    const int dg = qg - g;
+    const int db = qb - b;
+    if constexpr (Metric == COLOUR_METRIC_ABSOLUTE) {
+        return dr * dr + dg * dg + db * db;
+    } else {
+        const int rmean = (qr + r) / 2;
+        return (((512 + rmean) * dr * dr) >> 8) + 4 * dg * dg + (((767 - rmean) * db * db) >> 8);
+    }
+}
+
+template<ColourMetric Metric>
+inline float fromSquaredKey(int key) {
+    if constexpr (Metric == COLOUR_METRIC_ABSOLUTE) {
+        return absoluteDiffFromSquared(key);
+    } else {
+        return naturalDiffFromSquared(key);
+    }
+}
+
+template<ColourMetric Metric>
+constexpr bool isRgbMetric() {
+    return Metric == COLOUR_METRIC_ABSOLUTE || Metric == COLOUR_METRIC_NATURAL;
+}
+
+/// What getColourHueDiff or getColourLuminosityDiff scales the key
+/// difference by.
+template<ColourMetric Metric>
+constexpr float keyScale() {
+    return Metric == COLOUR_METRIC_HUE ? 127.5f : 255.0f;
+}
+
+template<ColourMetric Metric>
+float queryKey(const Colour &colour) {
+    return Metric == COLOUR_METRIC_HUE ? getColourHueKey(colour) : getColourLuminosityKey(colour);
+}
+
+/// What candidate `i` is reported as: its slot when `Slotted`, otherwise
+/// its index.
+template<bool Slotted>
+inline std::size_t rankOf(const ColourColumns &candidates, std::size_t i) {
+    if constexpr (Slotted) {
+        return candidates.slot[i];
+    } else {
+        return i;
+    }
+}
+
+template<ColourMetric Metric, bool Slotted>
+ColourMatch nearestScalar(const Colour &query, const ColourColumns &candidates,
+                          std::size_t begin, std::size_t end) {
+    std::size_t best_index = rankOf<Slotted>(candidates, begin);
+    if constexpr (isRgbMetric<Metric>()) {
+        int best_key = std::numeric_limits<int>::max();
+        for (std::size_t i = begin; i < end; ++i) {
+            const int key = squaredKey<Metric>(query.r, query.g, query.b,
+                                               candidates.r[i], candidates.g[i], candidates.b[i]);
+            if (key < best_key || (Slotted && key == best_key && candidates.slot[i] < best_index)) {
+                best_key = key;
+                best_index = rankOf<Slotted>(candidates, i);
+            }
+        }
+        return {best_index, fromSquaredKey<Metric>(best_key)};
+    } else {
+        const float key = queryKey<Metric>(query);
+        float best_diff = std::numeric_limits<float>::max();
+        for (std::size_t i = begin; i < end; ++i) {
+            const float diff = std::fabs(key - candidates.key[i]) * keyScale<Metric>();
+            if (diff < best_diff || (Slotted && diff == best_diff && candidates.slot[i] < best_index)) {
+                best_diff = diff;
+                best_index = rankOf<Slotted>(candidates, i);
+            }
+        }
+        return {best_index, best_diff};
+    }
+}
+
+// The SIMD kernels keep, per lane, the best key seen in that lane and the
+// index (or slot) it came from. Lanes take strictly smaller keys, or with
+// slots equal keys from lower slots, so each holds its lowest-ranked
+// minimum. finishLanes() reduces the lanes on (key, index) and scans the
+// ragged tail, which wins if closer or as close and lower-ranked.
+
+template<ColourMetric Metric, bool Slotted, typename Key>
+ColourMatch finishLanes(const Key *keys, const int *indices, std::size_t lanes,
+                        const Colour &query, const ColourColumns &candidates,
+                        std::size_t tail_begin, std::size_t end) {
+    std::size_t lane = 0;
+    for (std::size_t l = 1; l < lanes; ++l) {
+        if (keys[l] < keys[lane] || (keys[l] == keys[lane] && indices[l] < indices[lane])) {
+            lane = l;
+        }
+    }
+    ColourMatch best{std::size_t(indices[lane]), 0.0f};
+    if constexpr (isRgbMetric<Metric>()) {
+        best.difference = fromSquaredKey<Metric>(keys[lane]);
+    } else {
+        best.difference = keys[lane];
+    }
+    if (tail_begin < end) {
+        const ColourMatch tail = nearestScalar<Metric, Slotted>(query, candidates, tail_begin, end);
+        if (tail.difference < best.difference ||
+            (tail.difference == best.difference && tail.index < best.index)) {
+            best = tail;
+        }
+    }
+    return best;
+}
+
+}
+
+#ifdef RAINBOW_C_X86
+
+// GCC compiles a template instantiation with the target options in force
+// where the template is defined, so each kernel lives inside its own pragma
+// region.
+
+#pragma GCC push_options
+#pragma GCC target("sse4.2")
+
+namespace {
+
+inline __m128i loadSse(const std::uint8_t *bytes) {
+    std::int32_t packed;
+    std::memcpy(&packed, bytes, sizeof(packed));
+    return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+}
+
+template<bool Slotted>
+inline __m128i indexSse(const ColourColumns &candidates, std::size_t i, __m128i lane_offsets) {
+    if constexpr (Slotted) {
+        return _mm_loadu_si128((const __m128i *) &candidates.slot[i]);
+    } else {
+        return _mm_add_epi32(_mm_set1_epi32(int(i)), lane_offsets);
+    }
+}
+
+template<ColourMetric Metric, bool Slotted>
+ColourMatch nearestSse(const Colour &query, const ColourColumns &candidates,
+                       std::size_t begin, std::size_t end) {
+    constexpr std::size_t kLanes = 4;
+    if (end - begin < kLanes) {
+        return nearestScalar<Metric, Slotted>(query, candidates, begin, end);
+    }
+
+    const __m128i lane_offsets = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i best_index = _mm_setzero_si128();
+    alignas(16) int indices[kLanes];
+    std::size_t i = begin;
+
+    if constexpr (isRgbMetric<Metric>()) {
+        const __m128i qr = _mm_set1_epi32(query.r);
+        const __m128i qg = _mm_set1_epi32(query.g);
+        const __m128i qb = _mm_set1_epi32(query.b);
+        __m128i best_key = _mm_set1_epi32(std::numeric_limits<int>::max());
+        for (; i + kLanes <= end; i += kLanes) {
+            const __m128i r = loadSse(&candidates.r[i]);
+            const __m128i dr = _mm_sub_epi32(qr, r);
+            const __m128i dg = _mm_sub_epi32(qg, loadSse(&candidates.g[i]));
+            const __m128i db = _mm_sub_epi32(qb, loadSse(&candidates.b[i]));
+            const __m128i dr2 = _mm_mullo_epi32(dr, dr);
+            const __m128i dg2 = _mm_mullo_epi32(dg, dg);
+            const __m128i db2 = _mm_mullo_epi32(db, db);
+            __m128i key;
+            if constexpr (Metric == COLOUR_METRIC_ABSOLUTE) {
+                key = _mm_add_epi32(_mm_add_epi32(dr2, dg2), db2);
+            } else {
+                const __m128i rmean = _mm_srli_epi32(_mm_add_epi32(qr, r), 1);
+                const __m128i red = _mm_srai_epi32(
+                    _mm_mullo_epi32(_mm_add_epi32(_mm_set1_epi32(512), rmean), dr2), 8);
+                const __m128i blue = _mm_srai_epi32(
+                    _mm_mullo_epi32(_mm_sub_epi32(_mm_set1_epi32(767), rmean), db2), 8);
+                key = _mm_add_epi32(_mm_add_epi32(red, _mm_slli_epi32(dg2, 2)), blue);
+            }
+            const __m128i index = indexSse<Slotted>(candidates, i, lane_offsets);
+            __m128i closer = _mm_cmplt_epi32(key, best_key);
+            if constexpr (Slotted) {
+                closer = _mm_or_si128(closer, _mm_and_si128(_mm_cmpeq_epi32(key, best_key),
+                                                            _mm_cmplt_epi32(index, best_index)));
+            }
+            best_key = _mm_blendv_epi8(best_key, key, closer);
+            best_index = _mm_blendv_epi8(best_index, index, closer);
+        }
+
+        alignas(16) int keys[kLanes];
+        _mm_store_si128((__m128i *) keys, best_key);
+        _mm_store_si128((__m128i *) indices, best_index);
+        return finishLanes<Metric, Slotted>(keys, indices, kLanes, query, candidates, i, end);
+    } else {
+        const __m128 key = _mm_set1_ps(queryKey<Metric>(query));
+        const __m128 scale = _mm_set1_ps(keyScale<Metric>());
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        __m128 best_diff = _mm_set1_ps(std::numeric_limits<float>::max());
+        for (; i + kLanes <= end; i += kLanes) {
+            const __m128 diff = _mm_mul_ps(_mm_andnot_ps(sign, _mm_sub_ps(key, _mm_loadu_ps(&candidates.key[i]))),
+                                           scale);
+            const __m128i index = indexSse<Slotted>(candidates, i, lane_offsets);
+            __m128 closer = _mm_cmplt_ps(diff, best_diff);
+            if constexpr (Slotted) {
+                closer = _mm_or_ps(closer, _mm_and_ps(_mm_cmpeq_ps(diff, best_diff),
+                                                      _mm_castsi128_ps(_mm_cmplt_epi32(index, best_index))));
+            }
+            best_diff = _mm_blendv_ps(best_diff, diff, closer);
+            best_index = _mm_blendv_epi8(best_index, index, _mm_castps_si128(closer));
+        }
+
+        alignas(16) float diffs[kLanes];
+        _mm_store_ps(diffs, best_diff);
+        _mm_store_si128((__m128i *) indices, best_index);
+        return finishLanes<Metric, Slotted>(diffs, indices, kLanes, query, candidates, i, end);
+    }
+}
+
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+namespace {
+
+inline __m256i loadAvx2(const std::uint8_t *bytes) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) bytes));
+}
+
+template<bool Slotted>
+inline __m256i indexAvx2(const ColourColumns &candidates, std::size_t i, __m256i lane_offsets) {
+    if constexpr (Slotted) {
+        return _mm256_loadu_si256((const __m256i *) &candidates.slot[i]);
+    } else {
+        return _mm256_add_epi32(_mm256_set1_epi32(int(i)), lane_offsets);
+    }
+}
+
+template<ColourMetric Metric, bool Slotted>
+ColourMatch nearestAvx2(const Colour &query, const ColourColumns &candidates,
+                        std::size_t begin, std::size_t end) {
+    constexpr std::size_t kLanes = 8;
+    if (end - begin < kLanes) {
+        return nearestScalar<Metric, Slotted>(query, candidates, begin, end);
+    }
+
+    const __m256i lane_offsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i best_index = _mm256_setzero_si256();
+    alignas(32) int indices[kLanes];
+    std::size_t i = begin;
+
+    if constexpr (isRgbMetric<Metric>()) {
+        const __m256i qr = _mm256_set1_epi32(query.r);
+        const __m256i qg = _mm256_set1_epi32(query.g);
+        const __m256i qb = _mm256_set1_epi32(query.b);
+        __m256i best_key = _mm256_set1_epi32(std::numeric_limits<int>::max());
+        for (; i + kLanes <= end; i += kLanes) {
+            const __m256i r = loadAvx2(&candidates.r[i]);
+            const __m256i dr = _mm256_sub_epi32(qr, r);
+            const __m256i dg = _mm256_sub_epi32(qg, loadAvx2(&candidates.g[i]));
+            const __m256i db = _mm256_sub_epi32(qb, loadAvx2(&candidates.b[i]));
+            const __m256i dr2 = _mm256_mullo_epi32(dr, dr);
+            const __m256i dg2 = _mm256_mullo_epi32(dg, dg);
+            const __m256i db2 = _mm256_mullo_epi32(db, db);
+            __m256i key;
+            if constexpr (Metric == COLOUR_METRIC_ABSOLUTE) {
+                key = _mm256_add_epi32(_mm256_add_epi32(dr2, dg2), db2);
+            } else {
+                const __m256i rmean = _mm256_srli_epi32(_mm256_add_epi32(qr, r), 1);
+                const __m256i red = _mm256_srai_epi32(
+                    _mm256_mullo_epi32(_mm256_add_epi32(_mm256_set1_epi32(512), rmean), dr2), 8);
+                const __m256i blue = _mm256_srai_epi32(
+                    _mm256_mullo_epi32(_mm256_sub_epi32(_mm256_set1_epi32(767), rmean), db2), 8);
+                key = _mm256_add_epi32(_mm256_add_epi32(red, _mm256_slli_epi32(dg2, 2)), blue);
+            }
+            const __m256i index = indexAvx2<Slotted>(candidates, i, lane_offsets);
+            __m256i closer = _mm256_cmpgt_epi32(best_key, key);
+            if constexpr (Slotted) {
+                closer = _mm256_or_si256(closer, _mm256_and_si256(_mm256_cmpeq_epi32(key, best_key),
+                                                                  _mm256_cmpgt_epi32(best_index, index)));
+            }
+            best_key = _mm256_blendv_epi8(best_key, key, closer);
+            best_index = _mm256_blendv_epi8(best_index, index, closer);
+        }
+
+        alignas(32) int keys[kLanes];
+        _mm256_store_si256((__m256i *) keys, best_key);
+        _mm256_store_si256((__m256i *) indices, best_index);
+        return finishLanes<Metric, Slotted>(keys, indices, kLanes, query, candidates, i, end);
+    } else {
+        const __m256 key = _mm256_set1_ps(queryKey<Metric>(query));
+        const __m256 scale = _mm256_set1_ps(keyScale<Metric>());
+        const __m256 sign = _mm256_set1_ps(-0.0f);
+        __m256 best_diff = _mm256_set1_ps(std::numeric_limits<float>::max());
+        for (; i + kLanes <= end; i += kLanes) {
+            const __m256 diff = _mm256_mul_ps(
+                _mm256_andnot_ps(sign, _mm256_sub_ps(key, _mm256_loadu_ps(&candidates.key[i]))), scale);
+            const __m256i index = indexAvx2<Slotted>(candidates, i, lane_offsets);
+            __m256 closer = _mm256_cmp_ps(diff, best_diff, _CMP_LT_OQ);
+            if constexpr (Slotted) {
+                closer = _mm256_or_ps(closer, _mm256_and_ps(
+                    _mm256_cmp_ps(diff, best_diff, _CMP_EQ_OQ),
+                    _mm256_castsi256_ps(_mm256_cmpgt_epi32(best_index, index))));
+            }
+            best_diff = _mm256_blendv_ps(best_diff, diff, closer);
+            best_index = _mm256_blendv_epi8(best_index, index, _mm256_castps_si256(closer));
+        }
+
+        alignas(32) float diffs[kLanes];
+        _mm256_store_ps(diffs, best_diff);
+        _mm256_store_si256((__m256i *) indices, best_index);
+        return finishLanes<Metric, Slotted>(diffs, indices, kLanes, query, candidates, i, end);
+    }
+}
+
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+namespace {
+
+inline __m512i loadAvx512(const std::uint8_t *bytes) {
+    return _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *) bytes));
+}
+
+template<bool Slotted>
+inline __m512i indexAvx512(const ColourColumns &candidates, std::size_t i, __m512i lane_offsets) {
+    if constexpr (Slotted) {
+        return _mm512_loadu_si512(&candidates.slot[i]);
+    } else {
+        return _mm512_add_epi32(_mm512_set1_epi32(int(i)), lane_offsets);
+    }
+}
+
+template<ColourMetric Metric, bool Slotted>
+ColourMatch nearestAvx512(const Colour &query, const ColourColumns &candidates,
+                          std::size_t begin, std::size_t end) {
+    constexpr std::size_t kLanes = 16;
+    if (end - begin < kLanes) {
+        return nearestScalar<Metric, Slotted>(query, candidates, begin, end);
+    }
+
+    const __m512i lane_offsets = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m512i best_index = _mm512_setzero_si512();
+    alignas(64) int indices[kLanes];
+    std::size_t i = begin;
+
+    if constexpr (isRgbMetric<Metric>()) {
+        const __m512i qr = _mm512_set1_epi32(query.r);
+        const __m512i qg = _mm512_set1_epi32(query.g);
+        const __m512i qb = _mm512_set1_epi32(query.b);
+        __m512i best_key = _mm512_set1_epi32(std::numeric_limits<int>::max());
+        for (; i + kLanes <= end; i += kLanes) {
+            const __m512i r = loadAvx512(&candidates.r[i]);
+            const __m512i dr = _mm512_sub_epi32(qr, r);
+            const __m512i dg = _mm512_sub_epi32(qg, loadAvx512(&candidates.g[i]));
+            const __m512i db = _mm512_sub_epi32(qb, loadAvx512(&candidates.b[i]));
+            const __m512i dr2 = _mm512_mullo_epi32(dr, dr);
+            const __m512i dg2 = _mm512_mullo_epi32(dg, dg);
+            const __m512i db2 = _mm512_mullo_epi32(db, db);
+            __m512i key;
+            if constexpr (Metric == COLOUR_METRIC_ABSOLUTE) {
+                key = _mm512_add_epi32(_mm512_add_epi32(dr2, dg2), db2);
+            } else {
+                const __m512i rmean = _mm512_srli_epi32(_mm512_add_epi32(qr, r), 1);
+                const __m512i red = _mm512_srai_epi32(
+                    _mm512_mullo_epi32(_mm512_add_epi32(_mm512_set1_epi32(512), rmean), dr2), 8);
+                const __m512i blue = _mm512_srai_epi32(
+                    _mm512_mullo_epi32(_mm512_sub_epi32(_mm512_set1_epi32(767), rmean), db2), 8);
+                key = _mm512_add_epi32(_mm512_add_epi32(red, _mm512_slli_epi32(dg2, 2)), blue);
+            }
+            const __m512i index = indexAvx512<Slotted>(candidates, i, lane_offsets);
+            __mmask16 closer = _mm512_cmplt_epi32_mask(key, best_key);
+            if constexpr (Slotted) {
+                closer |= _mm512_cmpeq_epi32_mask(key, best_key) & _mm512_cmplt_epi32_mask(index, best_index);
+            }
+            best_key = _mm512_mask_mov_epi32(best_key, closer, key);
+            best_index = _mm512_mask_mov_epi32(best_index, closer, index);
+        }
+
+        alignas(64) int keys[kLanes];
+        _mm512_store_si512(keys, best_key);
+        _mm512_store_si512(indices, best_index);
+        return finishLanes<Metric, Slotted>(keys, indices, kLanes, query, candidates, i, end);
+    } else {
+        const __m512 key = _mm512_set1_ps(queryKey<Metric>(query));
+        const __m512 scale = _mm512_set1_ps(keyScale<Metric>());
+        __m512 best_diff = _mm512_set1_ps(std::numeric_limits<float>::max());
+        for (; i + kLanes <= end; i += kLanes) {
+            const __m512 diff = _mm512_mul_ps(
+                _mm512_abs_ps(_mm512_sub_ps(key, _mm512_loadu_ps(&candidates.key[i]))), scale);
+            const __m512i index = indexAvx512<Slotted>(candidates, i, lane_offsets);
+            __mmask16 closer = _mm512_cmp_ps_mask(diff, best_diff, _CMP_LT_OQ);
+            if constexpr (Slotted) {
+                closer |= _mm512_cmp_ps_mask(diff, best_diff, _CMP_EQ_OQ) &
+                          _mm512_cmplt_epi32_mask(index, best_index);
+            }
+            best_diff = _mm512_mask_mov_ps(best_diff, closer, diff);
+            best_index = _mm512_mask_mov_epi32(best_index, closer, index);
+        }
+
+        alignas(64) float diffs[kLanes];
+        _mm512_store_ps(diffs, best_diff);
+        _mm512_store_si512(indices, best_index);
+        return finishLanes<Metric, Slotted>(diffs, indices, kLanes, query, candidates, i, end);
+    }
+}
+
+}
+
+#pragma GCC pop_options
+
+#endif
+
+namespace {
+
+using NearestKernel = ColourMatch (*)(const Colour &, const ColourColumns &, std::size_t, std::size_t);
+
+/// One kernel per ColourMetric (bar COLOUR_METRIC_UNKNOWN), all from the
+/// same instruction set, for candidates ranked by index ([0]) or by slot
+/// ([1]).
+struct KernelTable {
+    const char *instruction_set;
+    NearestKernel nearest[2][COLOUR_METRIC_UNKNOWN];
+};
+
+template<template<ColourMetric, bool> class Tier>
+KernelTable makeTable(const char *instruction_set) {
+    return {instruction_set,
+            {{Tier<COLOUR_METRIC_ABSOLUTE, false>::nearest, Tier<COLOUR_METRIC_NATURAL, false>::nearest,
+              Tier<COLOUR_METRIC_HUE, false>::nearest, Tier<COLOUR_METRIC_LUMINOSITY, false>::nearest},
+             {Tier<COLOUR_METRIC_ABSOLUTE, true>::nearest, Tier<COLOUR_METRIC_NATURAL, true>::nearest,
+              Tier<COLOUR_METRIC_HUE, true>::nearest, Tier<COLOUR_METRIC_LUMINOSITY, true>::nearest}}};
+}
+
+template<ColourMetric Metric, bool Slotted>
+struct ScalarTier {
+    static constexpr NearestKernel nearest = nearestScalar<Metric, Slotted>;
+};
+
+#ifdef RAINBOW_C_X86
+template<ColourMetric Metric, bool Slotted>
+struct SseTier {
+    static constexpr NearestKernel nearest = nearestSse<Metric, Slotted>;
+};
+
+template<ColourMetric Metric, bool Slotted>
+struct Avx2Tier {
+    static constexpr NearestKernel nearest = nearestAvx2<Metric, Slotted>;
+};
+
+template<ColourMetric Metric, bool Slotted>
+struct Avx512Tier {
+    static constexpr NearestKernel nearest = nearestAvx512<Metric, Slotted>;
+};
+#endif
+
+KernelTable pickKernels() {
+#ifdef RAINBOW_C_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return makeTable<Avx512Tier>("AVX-512");
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return makeTable<Avx2Tier>("AVX2");
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return makeTable<SseTier>("SSE4.2");
+    }
+#endif
+    return makeTable<ScalarTier>("scalar");
+}
+
+const KernelTable &kernels() {
+    static const KernelTable table = pickKernels();
+    return table;
+}
+
+}
+
+ColourMatch nearestColour(ColourMetric metric, const Colour &query, const ColourColumns &candidates,
+                          std::size_t begin, std::size_t end) {
+    return kernels().nearest[candidates.slot != nullptr][metric](query, candidates, begin, end);
+}
+
+const char *colourBatchInstructionSet() {
+    return kernels().instruction_set;
+}
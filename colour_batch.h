@@ -0,0 +1,51 @@
+#ifndef RAINBOW_C_COLOUR_BATCH_H
+#define RAINBOW_C_COLOUR_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "colour.h"
+
+/// Batched versions of the getColour*Diff functions: one query colour
+/// against many candidates at once.
+///
+/// Each metric has a scalar, an SSE4.2, an AVX2 and an AVX-512 kernel. The
+/// widest one the CPU supports is picked the first time any of them is
+/// needed, so a single build runs on every x86-64 machine (and non-x86
+/// builds only get the scalar kernels).
+///
+/// Colour and natural candidates are ranked on the integer their
+/// *DiffFromSquared tail takes, in 32-bit lanes: those tails map distinct
+/// integers to distinct floats in the same order, so this ranks exactly as
+/// the float differences do. Hue and lum are ranked on the exact float
+/// difference, computed with the same operations as the scalar functions.
+
+/// Candidate colours as parallel arrays, indexed together.
+struct ColourColumns {
+    const std::uint8_t *r = nullptr;
+    const std::uint8_t *g = nullptr;
+    const std::uint8_t *b = nullptr;
+    // getColourHueKey or getColourLuminosityKey of each candidate. Only read
+    // for those two metrics.
+    const float *key = nullptr;
+    // Optional. When set, candidates are known by these numbers rather than
+    // their index: ties go to the lowest one, and it is what a ColourMatch
+    // reports. They must be distinct and below 2^31.
+    const std::uint32_t *slot = nullptr;
+};
+
+struct ColourMatch {
+    std::size_t index;
+    float difference;
+};
+
+/// The candidate in [begin, end) closest to `query` under `metric`, ties
+/// going to the lowest index (or slot), and its difference. The range must
+/// be non-empty and `metric` not COLOUR_METRIC_UNKNOWN.
+ColourMatch nearestColour(ColourMetric metric, const Colour &query, const ColourColumns &candidates,
+                          std::size_t begin, std::size_t end);
+
+/// Name of the instruction set nearestColour runs on, for logging.
+const char *colourBatchInstructionSet();
+
+#endif //RAINBOW_C_COLOUR_BATCH_H
@@ -0,0 +1,35 @@
+#ifndef RAINBOW_C_COLOUR_BITSET_H
+#define RAINBOW_C_COLOUR_BITSET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// One bit for every 8-bit RGB colour, indexed by 0xRRGGBB: 2 MiB for the
+/// whole cube, with constant-time membership.
+///
+/// Bits are packed 64 to a word in cube order, so word(i) covers colours
+/// 64 * i to 64 * i + 63 and a sweep can pass over 64 set (or clear) colours
+/// at once. Each word belongs to one red and green, which lets threads
+/// sweeping disjoint reds write their own words without sharing any.
+class ColourBitset {
+public:
+    static constexpr std::uint32_t kColours = 1u << 24;
+    static constexpr std::size_t kWords = kColours / 64;
+
+    ColourBitset() : words_(kWords, 0) {}
+
+    bool test(std::uint32_t rgb) const { return (this->words_[rgb / 64] >> (rgb % 64)) & 1u; }
+
+    void set(std::uint32_t rgb) { this->words_[rgb / 64] |= std::uint64_t(1) << (rgb % 64); }
+
+    /// The 64 bits for colours 64 * index onwards, lowest colour in bit 0.
+    std::uint64_t word(std::size_t index) const { return this->words_[index]; }
+
+    void setWord(std::size_t index, std::uint64_t bits) { this->words_[index] = bits; }
+
+private:
+    std::vector<std::uint64_t> words_;
+};
+
+#endif //RAINBOW_C_COLOUR_BITSET_H
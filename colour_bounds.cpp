@@ -0,0 +1,58 @@
+#include "colour_bounds.h"
+
+namespace {
+    // Float rounding means the triangle inequality can be off by a few ulps
+    // when evaluated on computed distances. Every bound gives up this much so
+    // a rounding error can never prune the true nearest colour. All distances
+    // are in [0, ~255], where float error is around 1e-5.
+    constexpr float kSlack = 1e-3f;
+
+    float sameMetricBound(float lower_bound) {
+        return lower_bound - kSlack;
+    }
+
+    float naturalBoundFromAbsolute(float absolute_lower_bound) {
+        // absolute = sqrt(E / 3) for the integer squared RGB distance E. In
+        // getNaturalColourDiff the red and blue weights are >= 2 (even after
+        // the >> 8) and green's is 4, so natural's squared term is >= 2E.
+        const float absolute = std::max(0.0f, absolute_lower_bound - kSlack);
+        return std::sqrt(6.0f * absolute * absolute) / std::sqrt(650000.0f) * 255.0f - kSlack;
+    }
+}
+
+void ColourBounds::expand(const Colour &colour) {
+    const int c[3] = {colour.r, colour.g, colour.b};
+    for (int axis = 0; axis < 3; ++axis) {
+        this->lo[axis] = std::min(this->lo[axis], c[axis]);
+        this->hi[axis] = std::max(this->hi[axis], c[axis]);
+    }
+}
+
+void ColourBounds::expand(const ColourBounds &other) {
+    for (int axis = 0; axis < 3; ++axis) {
+        this->lo[axis] = std::min(this->lo[axis], other.lo[axis]);
+        this->hi[axis] = std::max(this->hi[axis], other.hi[axis]);
+    }
+}
+
+bool ColourBounds::canBound(ColourMetric metric) {
+    return metric == COLOUR_METRIC_ABSOLUTE || metric == COLOUR_METRIC_NATURAL;
+}
+
+float ColourBounds::lowerBound(ColourMetric metric, const Colour &query) const {
+    switch (metric) {
+        case COLOUR_METRIC_ABSOLUTE:
+            return this->lowerBound<COLOUR_METRIC_ABSOLUTE>(query);
+        case COLOUR_METRIC_NATURAL:
+            return this->lowerBound<COLOUR_METRIC_NATURAL>(query);
+        default:
+            return 0.0f;
+    }
+}
+
+TriangleBound TriangleBound::forMetric(float (*difference_function)(const Colour &, const Colour &)) {
+    if (getColourMetric(difference_function) == COLOUR_METRIC_NATURAL) {
+        return {getColourAbsoluteDiff, naturalBoundFromAbsolute};
+    }
+    return {difference_function, sameMetricBound};
+}
@@ -0,0 +1,78 @@
+#ifndef RAINBOW_C_COLOUR_BOUNDS_H
+#define RAINBOW_C_COLOUR_BOUNDS_H
+
+#include "colour.h"
+
+/// An axis-aligned box in RGB space, used by the frontier indexes to skip
+/// whole groups of colours at once.
+///
+/// A default-constructed box is empty (lo > hi) and contains nothing;
+/// expand() grows it to cover each colour added.
+struct ColourBounds {
+    int lo[3] = {256, 256, 256};
+    int hi[3] = {-1, -1, -1};
+
+    bool empty() const { return lo[0] > hi[0]; }
+
+    /// Grow the box to include `colour`
+    void expand(const Colour &colour);
+
+    /// Grow the box to include every colour in `other`
+    void expand(const ColourBounds &other);
+
+    /// A value that is <= metric(query, c) for every colour c inside the
+    /// box, computed with the same float arithmetic as the metric itself so
+    /// the bound never overshoots by a rounding error. Returns 0 for metrics
+    /// it can't bound, which is always safe (nothing gets pruned).
+    float lowerBound(ColourMetric metric, const Colour &query) const;
+
+    /// lowerBound() for a metric fixed at compile time, so per-candidate
+    /// callers don't branch on it.
+    template<ColourMetric Metric>
+    float lowerBound(const Colour &query) const {
+        // Per-axis distance from the query to the nearest face of the box (0
+        // when the query lies within that axis' range).
+        const int q[3] = {query.r, query.g, query.b};
+        int d[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            d[axis] = q[axis] < this->lo[axis] ? this->lo[axis] - q[axis]
+                      : q[axis] > this->hi[axis] ? q[axis] - this->hi[axis]
+                      : 0;
+        }
+
+        if constexpr (Metric == COLOUR_METRIC_ABSOLUTE) {
+            return absoluteDiffFromSquared(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        } else if constexpr (Metric == COLOUR_METRIC_NATURAL) {
+            // The red and blue weights depend on the pair's mean red, which
+            // for colours in the box lies between these two. Each term is
+            // smallest at opposite ends of that range.
+            const int rmean_lo = (query.r + this->lo[0]) / 2;
+            const int rmean_hi = (query.r + this->hi[0]) / 2;
+            return naturalDiffFromSquared((((512 + rmean_lo) * d[0] * d[0]) >> 8)
+                                          + 4 * d[1] * d[1]
+                                          + (((767 - rmean_hi) * d[2] * d[2]) >> 8));
+        } else {
+            return 0.0f;
+        }
+    }
+
+    /// Whether lowerBound() gives a useful (non-zero) bound for `metric`.
+    static bool canBound(ColourMetric metric);
+};
+
+/// Lower bounds from the triangle inequality, for indexes that measure
+/// distances to reference colours rather than boxes.
+///
+/// `distance` is a true (pseudo-)metric, so if a colour is known to be at
+/// least `d` from some reference in it, `bound(d)` is a lower bound on the
+/// renderer's difference function. For colour, hue and lum that's the
+/// difference function itself; natural isn't a metric, so it goes through
+/// absolute RGB distance instead.
+struct TriangleBound {
+    float (*distance)(const Colour &, const Colour &);
+    float (*bound)(float distance_lower_bound);
+
+    static TriangleBound forMetric(float (*difference_function)(const Colour &, const Colour &));
+};
+
+#endif //RAINBOW_C_COLOUR_BOUNDS_H
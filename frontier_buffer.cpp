@@ -0,0 +1,70 @@
+#include "frontier_buffer.h"
+
+#include <limits>
+
+bool FrontierBuffer::supports(ColourMetric metric) {
+    return metric != COLOUR_METRIC_UNKNOWN;
+}
+
+FrontierBuffer::FrontierBuffer(ColourMetric metric, std::size_t shards)
+        : metric_(metric), shards_(shards == 0 ? 1 : shards) {
+}
+
+void FrontierBuffer::push(const Colour &colour) {
+    std::uint32_t smallest = 0;
+    for (std::uint32_t s = 1; s < this->shards_.size(); ++s) {
+        if (this->shards_[s].slot.size() < this->shards_[smallest].slot.size()) {
+            smallest = s;
+        }
+    }
+    Shard &shard = this->shards_[smallest];
+    this->where_.push_back({smallest, std::uint32_t(shard.slot.size())});
+    shard.r.push_back(std::uint8_t(colour.r));
+    shard.g.push_back(std::uint8_t(colour.g));
+    shard.b.push_back(std::uint8_t(colour.b));
+    shard.key.push_back(this->metric_ == COLOUR_METRIC_HUE ? getColourHueKey(colour)
+                                                           : getColourLuminosityKey(colour));
+    shard.slot.push_back(std::uint32_t(this->where_.size() - 1));
+}
+
+void FrontierBuffer::swapPop(std::size_t slot) {
+    // Drop the edge from its shard, moving the shard's last edge into the
+    // gap.
+    const Location gone = this->where_[slot];
+    Shard &shard = this->shards_[gone.shard];
+    const std::uint32_t moved = shard.slot.back();
+    shard.r[gone.position] = shard.r.back();
+    shard.g[gone.position] = shard.g.back();
+    shard.b[gone.position] = shard.b.back();
+    shard.key[gone.position] = shard.key.back();
+    shard.slot[gone.position] = moved;
+    shard.r.pop_back();
+    shard.g.pop_back();
+    shard.b.pop_back();
+    shard.key.pop_back();
+    shard.slot.pop_back();
+    this->where_[moved].position = gone.position;
+
+    // Then renumber the edge in the last slot to `slot`, wherever it lives.
+    const std::size_t last = this->where_.size() - 1;
+    if (slot != last) {
+        const Location location = this->where_[last];
+        this->shards_[location.shard].slot[location.position] = std::uint32_t(slot);
+        this->where_[slot] = location;
+    }
+    this->where_.pop_back();
+}
+
+ColourMatch FrontierBuffer::nearest(const Colour &colour, std::size_t shard) const {
+    const Shard &candidates = this->shards_[shard];
+    if (candidates.slot.empty()) {
+        return {0, std::numeric_limits<float>::max()};
+    }
+    ColourColumns columns;
+    columns.r = candidates.r.data();
+    columns.g = candidates.g.data();
+    columns.b = candidates.b.data();
+    columns.key = candidates.key.data();
+    columns.slot = candidates.slot.data();
+    return nearestColour(this->metric_, colour, columns, 0, candidates.slot.size());
+}
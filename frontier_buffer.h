@@ -0,0 +1,75 @@
+#ifndef RAINBOW_C_FRONTIER_BUFFER_H
+#define RAINBOW_C_FRONTIER_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "colour.h"
+#include "colour_batch.h"
+
+/// A structure-of-arrays copy of the colours of RainbowRenderer's
+/// available_edges, kept in step by pushEdge() and popEdge(), for the
+/// linear scan in edge_fill.
+///
+/// Scanning through available_edges means a dependent load into the pixel
+/// board for every candidate. Here the channels sit in contiguous byte
+/// arrays, so nearest() can stream them through nearestColour()'s SIMD
+/// kernels.
+///
+/// The edges are split into shards, one per thread scanning them, that each
+/// keep their own arrays for good. An edge stays in its shard until popped;
+/// popping only moves edges within a shard. Every edge records its slot in
+/// available_edges, so the closest match can still be broken towards the
+/// lowest slot whatever shard it is in.
+class FrontierBuffer {
+public:
+    /// Whether nearest() can rank by `metric`. The scan falls back to the
+    /// difference function pointer otherwise.
+    static bool supports(ColourMetric metric);
+
+    FrontierBuffer(ColourMetric metric, std::size_t shards);
+
+    std::size_t size() const { return this->where_.size(); }
+
+    std::size_t shardCount() const { return this->shards_.size(); }
+
+    /// Appends an edge of the given colour, at slot size(), to whichever
+    /// shard is smallest.
+    void push(const Colour &colour);
+
+    /// Moves the last edge into `slot` and drops the last slot.
+    void swapPop(std::size_t slot);
+
+    /// The slot in `shard` closest to `colour`, ties going to the lowest
+    /// slot, and its difference. An empty shard gives a difference of
+    /// FLT_MAX, which any edge beats.
+    ColourMatch nearest(const Colour &colour, std::size_t shard) const;
+
+private:
+    // On its own cache lines, so the thread scanning one shard never shares
+    // a line with another shard's bookkeeping.
+    struct alignas(64) Shard {
+        std::vector<std::uint8_t> r;
+        std::vector<std::uint8_t> g;
+        std::vector<std::uint8_t> b;
+        // getColourHueKey or getColourLuminosityKey of each edge; unused
+        // for the RGB metrics.
+        std::vector<float> key;
+        // Each edge's slot in available_edges.
+        std::vector<std::uint32_t> slot;
+    };
+
+    /// Where the edge in a slot lives.
+    struct Location {
+        std::uint32_t shard;
+        std::uint32_t position;
+    };
+
+    ColourMetric metric_;
+    std::vector<Shard> shards_;
+    // Indexed by slot.
+    std::vector<Location> where_;
+};
+
+#endif //RAINBOW_C_FRONTIER_BUFFER_H
@@ -0,0 +1,46 @@
+#ifndef RAINBOW_C_FRONTIER_INDEX_H
+#define RAINBOW_C_FRONTIER_INDEX_H
+
+#include <cstddef>
+
+#include "colour.h"
+#include "point.h"
+
+/// A search structure over the edge_fill frontier, kept in step with
+/// RainbowRenderer::available_edges by pushEdge() and popEdge().
+///
+/// Entries are identified by their slot — their position in
+/// available_edges. nearest() must return the slot whose colour minimises
+/// the renderer's difference function, breaking ties towards the lowest
+/// slot. That's exactly what the linear scan picks, so swapping an index in
+/// for the scan doesn't change the rendered image.
+///
+/// neighbour_fill reuses the same interface over (available point, filled
+/// neighbour) pairs, with slot = 8 * point index + neighbour direction, so
+/// slots there aren't contiguous.
+class FrontierIndex {
+public:
+    virtual ~FrontierIndex() = default;
+
+    /// Adds an edge of the given colour and board position at `slot`, which
+    /// must be free.
+    virtual void insert(std::size_t slot, const Point &point, const Colour &colour) = 0;
+
+    /// Removes the edge at `slot`.
+    virtual void remove(std::size_t slot) = 0;
+
+    /// The edge at `from` has been moved to the free slot `to` (popEdge's
+    /// swap-pop). Its colour is unchanged.
+    virtual void move(std::size_t from, std::size_t to) = 0;
+
+    /// The slot of the edge closest to `colour`. Only valid while the index
+    /// is non-empty.
+    ///
+    /// With a non-zero `approximation` the search may stop early and return
+    /// an edge up to (1 + approximation) times further away than the
+    /// closest: anything whose lower bound, scaled up by that factor, can't
+    /// beat the best found so far is skipped. 0 gives the exact answer.
+    virtual std::size_t nearest(const Colour &colour, float approximation) = 0;
+};
+
+#endif //RAINBOW_C_FRONTIER_INDEX_H
@@ -0,0 +1,125 @@
+#include "grid_frontier.h"
+
+#include <cstdlib>
+#include <limits>
+
+GridFrontier::GridFrontier(float (*difference_function)(const Colour &, const Colour &))
+    : difference_function_(difference_function),
+      metric_(getColourMetric(difference_function)),
+      cells_(kCellsPerAxis * kCellsPerAxis * kCellsPerAxis) {
+}
+
+int GridFrontier::cellOf(const Colour &colour) {
+    return ((colour.r / kCellWidth) * kCellsPerAxis + colour.g / kCellWidth) * kCellsPerAxis
+           + colour.b / kCellWidth;
+}
+
+void GridFrontier::insert(std::size_t slot, const Point &, const Colour &colour) {
+    const int cell = cellOf(colour);
+    if (slot >= this->locations_.size()) {
+        this->locations_.resize(slot + 1);
+    }
+    this->locations_[slot] = {cell, static_cast<int>(this->cells_[cell].size())};
+    this->cells_[cell].push_back({colour, static_cast<std::uint32_t>(slot)});
+}
+
+void GridFrontier::remove(std::size_t slot) {
+    const Location location = this->locations_[slot];
+    std::vector<Entry> &entries = this->cells_[location.cell];
+    if (location.position != static_cast<int>(entries.size()) - 1) {
+        entries[location.position] = entries.back();
+        this->locations_[entries[location.position].slot].position = location.position;
+    }
+    entries.pop_back();
+    this->locations_[slot] = Location();
+}
+
+void GridFrontier::move(std::size_t from, std::size_t to) {
+    const Location location = this->locations_[from];
+    this->cells_[location.cell][location.position].slot = static_cast<std::uint32_t>(to);
+    this->locations_[to] = location;
+    this->locations_[from] = Location();
+}
+
+std::size_t GridFrontier::nearest(const Colour &colour, float approximation) {
+    const float scale = 1.0f + approximation;
+    float best_diff = std::numeric_limits<float>::max();
+    std::size_t best_slot = std::numeric_limits<std::size_t>::max();
+
+    const int centre[3] = {colour.r / kCellWidth, colour.g / kCellWidth, colour.b / kCellWidth};
+
+    for (int shell = 0; shell < kCellsPerAxis; ++shell) {
+        // Strictly greater: an equal bound could still hide a lower-slot tie.
+        if (shell > 0 && this->shellLowerBound(colour, shell) * scale > best_diff) {
+            break;
+        }
+
+        // Walk every cell with max(|dr|, |dg|, |db|) == shell. Only the two
+        // faces at db = ±shell need visiting unless dr or dg is already on
+        // the shell, in which case the whole db range is on it.
+        for (int dr = -shell; dr <= shell; ++dr) {
+            const int cr = centre[0] + dr;
+            if (cr < 0 || cr >= kCellsPerAxis) continue;
+            for (int dg = -shell; dg <= shell; ++dg) {
+                const int cg = centre[1] + dg;
+                if (cg < 0 || cg >= kCellsPerAxis) continue;
+                const bool on_shell = std::abs(dr) == shell || std::abs(dg) == shell;
+                const int db_step = on_shell || shell == 0 ? 1 : 2 * shell;
+                for (int db = -shell; db <= shell; db += db_step) {
+                    const int cb = centre[2] + db;
+                    if (cb < 0 || cb >= kCellsPerAxis) continue;
+
+                    const std::vector<Entry> &entries =
+                            this->cells_[(cr * kCellsPerAxis + cg) * kCellsPerAxis + cb];
+                    if (entries.empty()) continue;
+
+                    ColourBounds cell_bounds;
+                    cell_bounds.lo[0] = cr * kCellWidth;
+                    cell_bounds.lo[1] = cg * kCellWidth;
+                    cell_bounds.lo[2] = cb * kCellWidth;
+                    for (int axis = 0; axis < 3; ++axis) {
+                        cell_bounds.hi[axis] = cell_bounds.lo[axis] + kCellWidth - 1;
+                    }
+                    if (cell_bounds.lowerBound(this->metric_, colour) * scale > best_diff) continue;
+
+                    for (const Entry &entry: entries) {
+                        const float diff = this->difference_function_(colour, entry.colour);
+                        if (diff < best_diff || (diff == best_diff && entry.slot < best_slot)) {
+                            best_diff = diff;
+                            best_slot = entry.slot;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return best_slot;
+}
+
+float GridFrontier::shellLowerBound(const Colour &colour, int shell) const {
+    // Any cell at Chebyshev distance >= shell is `shell` cells away on at
+    // least one axis, so it lies inside one of six slabs: "everything with
+    // red >= the start of cell centre_r + shell", and so on. The smallest
+    // slab bound covers them all.
+    const int q[3] = {colour.r, colour.g, colour.b};
+    float bound = std::numeric_limits<float>::max();
+    for (int axis = 0; axis < 3; ++axis) {
+        const int centre = q[axis] / kCellWidth;
+        for (int direction = -1; direction <= 1; direction += 2) {
+            const int cell = centre + direction * shell;
+            if (cell < 0 || cell >= kCellsPerAxis) continue;
+            ColourBounds slab;
+            for (int a = 0; a < 3; ++a) {
+                slab.lo[a] = 0;
+                slab.hi[a] = 255;
+            }
+            if (direction > 0) {
+                slab.lo[axis] = cell * kCellWidth;
+            } else {
+                slab.hi[axis] = cell * kCellWidth + kCellWidth - 1;
+            }
+            bound = std::min(bound, slab.lowerBound(this->metric_, colour));
+        }
+    }
+    return bound;
+}
@@ -0,0 +1,59 @@
+#ifndef RAINBOW_C_GRID_FRONTIER_H
+#define RAINBOW_C_GRID_FRONTIER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "colour_bounds.h"
+#include "frontier_index.h"
+
+/// A uniform grid over RGB space: each channel is quantised into kCellsPerAxis
+/// cells and every frontier edge is hashed into the cell holding its colour.
+///
+/// nearest() searches outward from the query colour's cell one shell at a
+/// time (all cells at Chebyshev distance s, then s + 1, ...) and stops once
+/// no cell in the next shell could beat the best distance found. When the
+/// frontier's colours sit close to the colours being placed — the usual case
+/// for flag renders — that's one or two shells.
+///
+/// Updates are O(1). Exact for any metric ColourBounds can bound.
+class GridFrontier : public FrontierIndex {
+public:
+    explicit GridFrontier(float (*difference_function)(const Colour &, const Colour &));
+
+    void insert(std::size_t slot, const Point &point, const Colour &colour) override;
+
+    void remove(std::size_t slot) override;
+
+    void move(std::size_t from, std::size_t to) override;
+
+    std::size_t nearest(const Colour &colour, float approximation) override;
+
+private:
+    static constexpr int kCellsPerAxis = 32;
+    static constexpr int kCellWidth = 256 / kCellsPerAxis;
+
+    struct Entry {
+        Colour colour;
+        std::uint32_t slot;
+    };
+
+    struct Location {
+        int cell = -1;
+        int position = -1;
+    };
+
+    float (*difference_function_)(const Colour &, const Colour &);
+    ColourMetric metric_;
+
+    std::vector<std::vector<Entry>> cells_;
+    std::vector<Location> locations_;
+
+    static int cellOf(const Colour &colour);
+
+    /// Lower bound on the difference between `colour` and anything in a
+    /// cell whose Chebyshev distance from `colour`'s own cell is >= `shell`.
+    float shellLowerBound(const Colour &colour, int shell) const;
+};
+
+#endif //RAINBOW_C_GRID_FRONTIER_H
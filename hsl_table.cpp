@@ -0,0 +1,340 @@
+#include "hsl_table.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RAINBOW_C_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Every 8-bit RGB colour.
+constexpr std::uint32_t kCubeColours = 1u << 24;
+
+// A table file starts with this, padded out to kHeaderSize so the planes
+// after it start on a cache line: hue, then sat, then lum.
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t colours;
+};
+
+constexpr char kMagic[8] = {'R', 'B', 'H', 'S', 'L', 'T', 'A', 'B'};
+// Bump when rgbToHsl or the file layout changes, so old files get rebuilt.
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kHeaderSize = 64;
+constexpr std::size_t kTableSize = kHeaderSize + 3 * std::size_t(kCubeColours) * sizeof(float);
+
+/// Fills in the 256 colours with red and green `rg` (0xRRGG) and blue 0 to
+/// 255, writing their HSL to hue[0..255], sat[0..255] and lum[0..255].
+using RowKernel = void (*)(std::uint32_t rg, float *hue, float *sat, float *lum);
+
+void rowScalar(std::uint32_t rg, float *hue, float *sat, float *lum) {
+    for (int b = 0; b < 256; ++b) {
+        const auto t = rgbToHsl(int(rg >> 8), int(rg & 0xff), b);
+        hue[b] = std::get<0>(t);
+        sat[b] = std::get<1>(t);
+        lum[b] = std::get<2>(t);
+    }
+}
+
+}
+
+#ifdef RAINBOW_C_X86
+
+// The kernels below do rgbToHsl's operations in its order, in every lane,
+// then pick each lane's result the way its branches would. Every operation
+// is a correctly rounded IEEE one, so each lane comes out bit for bit as
+// rgbToHsl's. Lanes where max == min divide by zero along the way, but are
+// zeroed before the store.
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+namespace {
+
+void rowAvx2(std::uint32_t rg, float *hue, float *sat, float *lum) {
+    const __m256 full = _mm256_set1_ps(255.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 four = _mm256_set1_ps(4.0f);
+    const __m256 six = _mm256_set1_ps(6.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 r = _mm256_div_ps(_mm256_set1_ps(float(rg >> 8)), full);
+    const __m256 g = _mm256_div_ps(_mm256_set1_ps(float(rg & 0xff)), full);
+    __m256 blue = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+
+    for (int i = 0; i < 256; i += 8) {
+        const __m256 b = _mm256_div_ps(blue, full);
+        blue = _mm256_add_ps(blue, _mm256_set1_ps(8.0f));
+
+        const __m256 max = _mm256_max_ps(r, _mm256_max_ps(g, b));
+        const __m256 min = _mm256_min_ps(r, _mm256_min_ps(g, b));
+        const __m256 l = _mm256_div_ps(_mm256_add_ps(max, min), two);
+        const __m256 diff = _mm256_sub_ps(max, min);
+        const __m256 grey = _mm256_cmp_ps(max, min, _CMP_EQ_OQ);
+
+        const __m256 s = _mm256_blendv_ps(_mm256_div_ps(diff, _mm256_add_ps(max, min)),
+                                          _mm256_div_ps(diff, _mm256_sub_ps(_mm256_sub_ps(two, max), min)),
+                                          _mm256_cmp_ps(l, half, _CMP_GT_OQ));
+
+        const __m256 red_max = _mm256_and_ps(_mm256_cmp_ps(r, g, _CMP_GT_OQ), _mm256_cmp_ps(r, b, _CMP_GT_OQ));
+        const __m256 green_max = _mm256_cmp_ps(g, b, _CMP_GT_OQ);
+        const __m256 from_red = _mm256_add_ps(_mm256_div_ps(_mm256_sub_ps(g, b), diff),
+                                              _mm256_and_ps(_mm256_cmp_ps(g, b, _CMP_LT_OQ), six));
+        const __m256 from_green = _mm256_add_ps(_mm256_div_ps(_mm256_sub_ps(b, r), diff), two);
+        const __m256 from_blue = _mm256_add_ps(_mm256_div_ps(_mm256_sub_ps(r, g), diff), four);
+        const __m256 h = _mm256_div_ps(
+            _mm256_blendv_ps(_mm256_blendv_ps(from_blue, from_green, green_max), from_red, red_max), six);
+
+        _mm256_storeu_ps(hue + i, _mm256_andnot_ps(grey, h));
+        _mm256_storeu_ps(sat + i, _mm256_andnot_ps(grey, s));
+        _mm256_storeu_ps(lum + i, l);
+    }
+}
+
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+namespace {
+
+void rowAvx512(std::uint32_t rg, float *hue, float *sat, float *lum) {
+    const __m512 full = _mm512_set1_ps(255.0f);
+    const __m512 two = _mm512_set1_ps(2.0f);
+    const __m512 four = _mm512_set1_ps(4.0f);
+    const __m512 six = _mm512_set1_ps(6.0f);
+    const __m512 half = _mm512_set1_ps(0.5f);
+    const __m512 r = _mm512_div_ps(_mm512_set1_ps(float(rg >> 8)), full);
+    const __m512 g = _mm512_div_ps(_mm512_set1_ps(float(rg & 0xff)), full);
+    __m512 blue = _mm512_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+                                 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f);
+
+    for (int i = 0; i < 256; i += 16) {
+        const __m512 b = _mm512_div_ps(blue, full);
+        blue = _mm512_add_ps(blue, _mm512_set1_ps(16.0f));
+
+        const __m512 max = _mm512_max_ps(r, _mm512_max_ps(g, b));
+        const __m512 min = _mm512_min_ps(r, _mm512_min_ps(g, b));
+        const __m512 l = _mm512_div_ps(_mm512_add_ps(max, min), two);
+        const __m512 diff = _mm512_sub_ps(max, min);
+        const __mmask16 coloured = _mm512_cmp_ps_mask(max, min, _CMP_NEQ_OQ);
+
+        const __m512 s = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(l, half, _CMP_GT_OQ),
+                                              _mm512_div_ps(diff, _mm512_add_ps(max, min)),
+                                              _mm512_div_ps(diff, _mm512_sub_ps(_mm512_sub_ps(two, max), min)));
+
+        const __mmask16 red_max = _mm512_cmp_ps_mask(r, g, _CMP_GT_OQ) & _mm512_cmp_ps_mask(r, b, _CMP_GT_OQ);
+        const __mmask16 green_max = _mm512_cmp_ps_mask(g, b, _CMP_GT_OQ);
+        const __m512 from_red = _mm512_add_ps(_mm512_div_ps(_mm512_sub_ps(g, b), diff),
+                                              _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(g, b, _CMP_LT_OQ), six));
+        const __m512 from_green = _mm512_add_ps(_mm512_div_ps(_mm512_sub_ps(b, r), diff), two);
+        const __m512 from_blue = _mm512_add_ps(_mm512_div_ps(_mm512_sub_ps(r, g), diff), four);
+        const __m512 h = _mm512_div_ps(
+            _mm512_mask_blend_ps(red_max, _mm512_mask_blend_ps(green_max, from_blue, from_green), from_red), six);
+
+        _mm512_storeu_ps(hue + i, _mm512_maskz_mov_ps(coloured, h));
+        _mm512_storeu_ps(sat + i, _mm512_maskz_mov_ps(coloured, s));
+        _mm512_storeu_ps(lum + i, l);
+    }
+}
+
+}
+
+#pragma GCC pop_options
+
+#endif
+
+namespace {
+
+struct RowBuilder {
+    const char *instruction_set;
+    RowKernel row;
+};
+
+RowBuilder pickBuilder() {
+#ifdef RAINBOW_C_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return {"AVX-512", rowAvx512};
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return {"AVX2", rowAvx2};
+    }
+#endif
+    return {"scalar", rowScalar};
+}
+
+const RowBuilder &builder() {
+    static const RowBuilder row_builder = pickBuilder();
+    return row_builder;
+}
+
+std::runtime_error fileError(const std::string &what, const std::string &path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+}
+
+HslTable::~HslTable() {
+    if (this->mapping_) {
+        munmap(this->mapping_, this->mapping_size_);
+    }
+}
+
+void HslTable::load(const std::string &path, ThreadPool &pool) {
+    if (path.empty()) {
+        void *mapping = mmap(nullptr, kTableSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Could not allocate the HSL table");
+        }
+        this->build(mapping, pool);
+        this->check(mapping);
+        return;
+    }
+
+    // A table that's already there is mapped read-only and shared, and
+    // faulted in up front rather than a page at a time.
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    flags |= MAP_POPULATE;
+#endif
+    const int in = open(path.c_str(), O_RDONLY);
+    if (in >= 0) {
+        struct stat status{};
+        void *mapping = MAP_FAILED;
+        if (fstat(in, &status) == 0 && std::size_t(status.st_size) == kTableSize) {
+            mapping = mmap(nullptr, kTableSize, PROT_READ, flags, in, 0);
+        }
+        close(in);
+        if (mapping != MAP_FAILED) {
+            if (this->adopt(mapping, kTableSize)) {
+                this->mapped_ = true;
+                return;
+            }
+            munmap(mapping, kTableSize);
+        }
+    } else if (errno != ENOENT) {
+        throw fileError("Could not open the HSL table", path);
+    }
+
+    // Otherwise build it into a file of our own and move that into place:
+    // nothing ever maps a half-written table, and runs racing to build it
+    // each leave a whole one. The space is allocated first, so a full disk
+    // fails here rather than faulting on a write into the mapping.
+    const std::string temporary = path + ".tmp" + std::to_string(getpid());
+    const int out = open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        throw fileError("Could not create the HSL table", temporary);
+    }
+    const int allocated = posix_fallocate(out, 0, off_t(kTableSize));
+    void *mapping = MAP_FAILED;
+    if (allocated == 0) {
+        mapping = mmap(nullptr, kTableSize, PROT_READ | PROT_WRITE, MAP_SHARED, out, 0);
+    } else {
+        errno = allocated;
+    }
+    close(out);
+    if (mapping == MAP_FAILED) {
+        const std::runtime_error error = fileError("Could not size the HSL table", temporary);
+        unlink(temporary.c_str());
+        throw error;
+    }
+    this->build(mapping, pool);
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        const std::runtime_error error = fileError("Could not save the HSL table to", path);
+        munmap(mapping, kTableSize);
+        unlink(temporary.c_str());
+        throw error;
+    }
+    this->check(mapping);
+}
+
+Colour HslTable::colour(std::uint32_t rgb) const {
+    Colour colour;
+    colour.r = int(rgb >> 16);
+    colour.g = int((rgb >> 8) & 0xff);
+    colour.b = int(rgb & 0xff);
+    colour.hue = this->hue_[rgb];
+    colour.sat = this->sat_[rgb];
+    colour.lum = this->lum_[rgb];
+    return colour;
+}
+
+const char *HslTable::instructionSet() {
+    return builder().instruction_set;
+}
+
+void HslTable::build(void *mapping, ThreadPool &pool) {
+    float *hue = reinterpret_cast<float *>(static_cast<char *>(mapping) + kHeaderSize);
+    float *sat = hue + kCubeColours;
+    float *lum = sat + kCubeColours;
+    const RowKernel row = builder().row;
+
+    // One row per red and green, each chunk writing only its own rows.
+    pool.parallel_reduce<bool>(
+        kCubeColours >> 8,
+        [&](std::size_t start, std::size_t end) {
+            for (std::size_t rg = start; rg < end; ++rg) {
+                row(std::uint32_t(rg), hue + (rg << 8), sat + (rg << 8), lum + (rg << 8));
+            }
+            return true;
+        },
+        [](bool left, bool right) { return left && right; });
+
+    // Written last, so a table only looks complete once it is.
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.colours = kCubeColours;
+    std::memcpy(mapping, &header, sizeof(header));
+}
+
+void HslTable::check(void *mapping) {
+    if (!this->adopt(mapping, kTableSize)) {
+        munmap(mapping, kTableSize);
+        throw std::runtime_error("The HSL table just built doesn't match rgbToHsl");
+    }
+}
+
+bool HslTable::adopt(void *mapping, std::size_t size) {
+    Header header{};
+    std::memcpy(&header, mapping, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.colours != kCubeColours) {
+        return false;
+    }
+    const float *hue = reinterpret_cast<const float *>(static_cast<const char *>(mapping) + kHeaderSize);
+    const float *sat = hue + kCubeColours;
+    const float *lum = sat + kCubeColours;
+
+    // Spot check a few hundred colours spread over the cube against
+    // rgbToHsl, which catches a file from a build whose floats differ.
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        const std::uint32_t rgb = (i * 2654435761u) >> 8;
+        const auto t = rgbToHsl(int(rgb >> 16), int((rgb >> 8) & 0xff), int(rgb & 0xff));
+        const float expected[3] = {std::get<0>(t), std::get<1>(t), std::get<2>(t)};
+        const float found[3] = {hue[rgb], sat[rgb], lum[rgb]};
+        if (std::memcmp(expected, found, sizeof(expected)) != 0) {
+            return false;
+        }
+    }
+
+    this->mapping_ = mapping;
+    this->mapping_size_ = size;
+    this->hue_ = hue;
+    this->sat_ = sat;
+    this->lum_ = lum;
+    return true;
+}
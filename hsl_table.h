@@ -0,0 +1,74 @@
+#ifndef RAINBOW_C_HSL_TABLE_H
+#define RAINBOW_C_HSL_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "colour.h"
+#include "thread_pool.h"
+
+/// Hue, saturation and luminosity of every 8-bit RGB colour, bit for bit as
+/// rgbToHsl gives them, for the passes over the whole colour cube.
+///
+/// The table is three planes of 2^24 floats indexed by 0xRRGGBB, 192 MiB in
+/// all. It is built a row of 256 blues at a time by the widest SIMD kernel
+/// the CPU has, across the thread pool. Given a file, it is kept there and
+/// mapped rather than rebuilt, so later runs just page it in, sharing one
+/// copy through the page cache.
+///
+/// Lookups are meant for sweeps in cube order. A lone lookup is a cache miss
+/// that costs more than rgbToHsl, so Colour still works its HSL out itself.
+class HslTable {
+public:
+    HslTable() = default;
+
+    ~HslTable();
+
+    HslTable(const HslTable &) = delete;
+
+    HslTable &operator=(const HslTable &) = delete;
+
+    /// Whether load() has run.
+    bool loaded() const { return this->mapping_ != nullptr; }
+
+    /// Fills the table. With an empty `path` it is built in memory. Otherwise
+    /// it is mapped from `path`, after building it into that file if there is
+    /// none yet or the one there was written by a different version. Throws
+    /// std::runtime_error if the file can't be read or written.
+    void load(const std::string &path, ThreadPool &pool);
+
+    /// Whether load() found the file already built.
+    bool wasMapped() const { return this->mapped_; }
+
+    float hue(std::uint32_t rgb) const { return this->hue_[rgb]; }
+
+    float sat(std::uint32_t rgb) const { return this->sat_[rgb]; }
+
+    float lum(std::uint32_t rgb) const { return this->lum_[rgb]; }
+
+    /// The Colour for 0xRRGGBB, the same as Colour(r, g, b) gives.
+    Colour colour(std::uint32_t rgb) const;
+
+    /// Name of the instruction set the table is built with, for logging.
+    static const char *instructionSet();
+
+private:
+    void *mapping_ = nullptr;
+    std::size_t mapping_size_ = 0;
+    bool mapped_ = false;
+    const float *hue_ = nullptr;
+    const float *sat_ = nullptr;
+    const float *lum_ = nullptr;
+
+    void build(void *mapping, ThreadPool &pool);
+
+    // Takes on a built table if its header and a sample of its colours are
+    // right, returning whether they were.
+    bool adopt(void *mapping, std::size_t size);
+
+    // adopt() for a table this run built, which has to be right.
+    void check(void *mapping);
+};
+
+#endif //RAINBOW_C_HSL_TABLE_H
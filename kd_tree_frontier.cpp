@@ -0,0 +1,213 @@
+#include "kd_tree_frontier.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+    int channel(const Colour &colour, int axis) {
+        return axis == 0 ? colour.r : axis == 1 ? colour.g : colour.b;
+    }
+
+    /// Picks the widest axis of `entries` and a split value on it such that
+    /// both halves are non-empty. Returns false when every entry has the
+    /// same colour and no such split exists.
+    template<typename Entry>
+    bool chooseSplit(std::vector<Entry> &entries, int &axis, int &split) {
+        ColourBounds bounds;
+        for (const Entry &entry: entries) {
+            bounds.expand(entry.colour);
+        }
+        axis = 0;
+        for (int a = 1; a < 3; ++a) {
+            if (bounds.hi[a] - bounds.lo[a] > bounds.hi[axis] - bounds.lo[axis]) {
+                axis = a;
+            }
+        }
+        if (bounds.hi[axis] == bounds.lo[axis]) {
+            return false;
+        }
+
+        // Median split. If the median equals the minimum, everything equal
+        // to it goes left instead, so the left half is never empty.
+        const auto mid = entries.begin() + entries.size() / 2;
+        std::nth_element(entries.begin(), mid, entries.end(), [axis](const Entry &a, const Entry &b) {
+            return channel(a.colour, axis) < channel(b.colour, axis);
+        });
+        split = channel(mid->colour, axis);
+        if (split == bounds.lo[axis]) {
+            ++split;
+        }
+        return true;
+    }
+}
+
+KdTreeFrontier::KdTreeFrontier(float (*difference_function)(const Colour &, const Colour &))
+    : difference_function_(difference_function),
+      metric_(getColourMetric(difference_function)) {
+    this->nodes_.emplace_back();
+}
+
+void KdTreeFrontier::insert(std::size_t slot, const Point &, const Colour &colour) {
+    int node = 0;
+    while (this->nodes_[node].axis >= 0) {
+        Node &n = this->nodes_[node];
+        n.bounds.expand(colour);
+        node = n.children[channel(colour, n.axis) < n.split ? 0 : 1];
+    }
+
+    Node &leaf = this->nodes_[node];
+    leaf.bounds.expand(colour);
+    if (slot >= this->locations_.size()) {
+        this->locations_.resize(slot + 1);
+    }
+    this->locations_[slot] = {node, static_cast<int>(leaf.entries.size())};
+    leaf.entries.push_back({colour, static_cast<std::uint32_t>(slot)});
+    ++this->size_;
+    ++this->churn_;
+
+    if (leaf.entries.size() > leaf.split_at) {
+        this->splitLeaf(node);
+    }
+}
+
+void KdTreeFrontier::remove(std::size_t slot) {
+    const Location location = this->locations_[slot];
+    std::vector<Entry> &entries = this->nodes_[location.node].entries;
+
+    // Swap-pop within the leaf, same trick as RainbowRenderer::popEdge.
+    if (location.position != static_cast<int>(entries.size()) - 1) {
+        entries[location.position] = entries.back();
+        this->locations_[entries[location.position].slot].position = location.position;
+    }
+    entries.pop_back();
+    this->locations_[slot] = Location();
+    --this->size_;
+    ++this->churn_;
+
+    if (this->churn_ > 2 * this->size_ + 1024) {
+        this->rebuild();
+    } else {
+        this->refreshBounds(location.node);
+    }
+}
+
+void KdTreeFrontier::move(std::size_t from, std::size_t to) {
+    const Location location = this->locations_[from];
+    this->nodes_[location.node].entries[location.position].slot = static_cast<std::uint32_t>(to);
+    this->locations_[to] = location;
+    this->locations_[from] = Location();
+}
+
+std::size_t KdTreeFrontier::nearest(const Colour &colour, float approximation) {
+    const float scale = 1.0f + approximation;
+    float best_diff = std::numeric_limits<float>::max();
+    std::size_t best_slot = std::numeric_limits<std::size_t>::max();
+
+    this->stack_.clear();
+    this->stack_.push_back(0);
+    while (!this->stack_.empty()) {
+        const Node &node = this->nodes_[this->stack_.back()];
+        this->stack_.pop_back();
+
+        // A node whose bound equals best_diff can still hold a tie with a
+        // lower slot, so only prune when strictly worse.
+        if (node.bounds.empty() || node.bounds.lowerBound(this->metric_, colour) * scale > best_diff) {
+            continue;
+        }
+
+        if (node.axis < 0) {
+            for (const Entry &entry: node.entries) {
+                const float diff = this->difference_function_(colour, entry.colour);
+                if (diff < best_diff || (diff == best_diff && entry.slot < best_slot)) {
+                    best_diff = diff;
+                    best_slot = entry.slot;
+                }
+            }
+            continue;
+        }
+
+        // Push the far child first so the near one is searched first and
+        // tightens best_diff before the far one is considered.
+        const int near = channel(colour, node.axis) < node.split ? 0 : 1;
+        this->stack_.push_back(node.children[1 - near]);
+        this->stack_.push_back(node.children[near]);
+    }
+    return best_slot;
+}
+
+void KdTreeFrontier::build(int node, std::vector<Entry> &entries) {
+    int axis, split;
+    if (entries.size() <= kLeafSize || !chooseSplit(entries, axis, split)) {
+        Node &leaf = this->nodes_[node];
+        leaf.axis = -1;
+        // A leaf of one colour can't be split, and won't be until other
+        // colours join it, so wait until it has doubled to try again.
+        leaf.split_at = std::max(kLeafSize, 2 * entries.size());
+        leaf.entries = std::move(entries);
+        leaf.bounds = ColourBounds();
+        for (std::size_t i = 0; i < leaf.entries.size(); ++i) {
+            leaf.bounds.expand(leaf.entries[i].colour);
+            this->locations_[leaf.entries[i].slot] = {node, static_cast<int>(i)};
+        }
+        return;
+    }
+
+    std::vector<Entry> halves[2];
+    for (Entry &entry: entries) {
+        halves[channel(entry.colour, axis) < split ? 0 : 1].push_back(entry);
+    }
+    entries.clear();
+    entries.shrink_to_fit();
+
+    // Create both children before recursing: emplace_back may reallocate
+    // nodes_, so no Node references are held across it.
+    const int children[2] = {static_cast<int>(this->nodes_.size()), static_cast<int>(this->nodes_.size()) + 1};
+    this->nodes_.emplace_back();
+    this->nodes_.emplace_back();
+    for (int child: children) {
+        this->nodes_[child].parent = node;
+    }
+    Node &n = this->nodes_[node];
+    n.axis = axis;
+    n.split = split;
+    n.children[0] = children[0];
+    n.children[1] = children[1];
+    n.entries.clear();
+    n.entries.shrink_to_fit();
+
+    this->build(children[0], halves[0]);
+    this->build(children[1], halves[1]);
+    this->nodes_[node].bounds = this->nodes_[children[0]].bounds;
+    this->nodes_[node].bounds.expand(this->nodes_[children[1]].bounds);
+}
+
+void KdTreeFrontier::splitLeaf(int node) {
+    // build() already falls back to a leaf when no split exists.
+    std::vector<Entry> entries = std::move(this->nodes_[node].entries);
+    this->build(node, entries);
+}
+
+void KdTreeFrontier::refreshBounds(int node) {
+    Node &leaf = this->nodes_[node];
+    leaf.bounds = ColourBounds();
+    for (const Entry &entry: leaf.entries) {
+        leaf.bounds.expand(entry.colour);
+    }
+    for (int parent = leaf.parent; parent >= 0; parent = this->nodes_[parent].parent) {
+        Node &p = this->nodes_[parent];
+        p.bounds = this->nodes_[p.children[0]].bounds;
+        p.bounds.expand(this->nodes_[p.children[1]].bounds);
+    }
+}
+
+void KdTreeFrontier::rebuild() {
+    std::vector<Entry> entries;
+    entries.reserve(this->size_);
+    for (Node &node: this->nodes_) {
+        entries.insert(entries.end(), node.entries.begin(), node.entries.end());
+    }
+    this->nodes_.clear();
+    this->nodes_.emplace_back();
+    this->build(0, entries);
+    this->churn_ = 0;
+}
@@ -0,0 +1,92 @@
+#ifndef RAINBOW_C_KD_TREE_FRONTIER_H
+#define RAINBOW_C_KD_TREE_FRONTIER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "colour_bounds.h"
+#include "frontier_index.h"
+
+/// A dynamic k-d tree over the RGB colours of the frontier.
+///
+/// Entries live in leaf buckets of up to kLeafSize colours. A bucket that
+/// overflows is split at the median of its widest axis, so the tree grows
+/// where the frontier is dense. Every node keeps the exact bounding box of
+/// the colours beneath it (shrunk again on removal), which is what nearest()
+/// prunes against.
+///
+/// Leaves are never merged back together, so after enough churn the tree
+/// is rebuilt from its live entries. That happens after O(size) updates, so
+/// the cost amortises to O(log n) per update.
+class KdTreeFrontier : public FrontierIndex {
+public:
+    explicit KdTreeFrontier(float (*difference_function)(const Colour &, const Colour &));
+
+    void insert(std::size_t slot, const Point &point, const Colour &colour) override;
+
+    void remove(std::size_t slot) override;
+
+    void move(std::size_t from, std::size_t to) override;
+
+    std::size_t nearest(const Colour &colour, float approximation) override;
+
+private:
+    static constexpr std::size_t kLeafSize = 16;
+
+    struct Entry {
+        Colour colour;
+        std::uint32_t slot;
+    };
+
+    struct Node {
+        ColourBounds bounds;
+        // Splitting axis (0 = r, 1 = g, 2 = b), or -1 for a leaf. Colours
+        // whose channel is < split go to children[0], the rest to children[1].
+        int axis = -1;
+        int split = 0;
+        int children[2] = {-1, -1};
+        int parent = -1;
+        // Only populated for leaves.
+        std::vector<Entry> entries;
+        // A leaf is split once it holds more entries than this: kLeafSize,
+        // or twice what it held when it last couldn't be split.
+        std::size_t split_at = kLeafSize;
+    };
+
+    /// Where each slot's entry currently lives: a leaf and a position in
+    /// that leaf's entries.
+    struct Location {
+        int node = -1;
+        int position = -1;
+    };
+
+    float (*difference_function_)(const Colour &, const Colour &);
+    ColourMetric metric_;
+
+    std::vector<Node> nodes_;
+    std::vector<Location> locations_;
+    std::size_t size_ = 0;
+
+    // Inserts + removes since the last rebuild. Triggers a rebuild once it
+    // outgrows the live entry count.
+    std::size_t churn_ = 0;
+
+    // Scratch stack for nearest(), kept around so queries don't allocate.
+    std::vector<int> stack_;
+
+    /// Turns `node` into the root of a balanced subtree over `entries`.
+    void build(int node, std::vector<Entry> &entries);
+
+    /// Splits an overflowing leaf in two. Leaves it as is, to be retried
+    /// once it has doubled, if every entry has the same colour.
+    void splitLeaf(int node);
+
+    /// Recomputes a leaf's bounds from its entries and refreshes every
+    /// ancestor's bounds from its children.
+    void refreshBounds(int node);
+
+    /// Throws the tree away and rebuilds it over the live entries.
+    void rebuild();
+};
+
+#endif //RAINBOW_C_KD_TREE_FRONTIER_H
@@ -21,7 +21,7 @@ int main(int argc, char *argv[]) {
     RainbowRenderer rainbow_renderer;
 
     int c;
-    while ((c = getopt(argc, argv, "h:w:H:c:d:r:f:o:l:L:s:S:p:n:F:C:P:B")) != -1) {
+    while ((c = getopt(argc, argv, "h:w:H:c:d:r:f:e:a:b:o:l:L:s:S:p:n:N:F:C:P:T:B")) != -1) {
         switch (c) {
             case 'w': {
                 // Width
@@ -226,6 +226,99 @@ int main(int argc, char *argv[]) {
                 rainbow_renderer.setFillMode(fill_mode);
                 break;
             }
+            case 'e': {
+                // Frontier search used by the edge fill mode
+                std::string frontier_str = optarg;
+                RainbowRenderer::FrontierType frontier_type;
+                if (frontier_str == "auto") {
+                    // Default: sorted for -d lum and -d hue, kdtree for -f neighbour, scan otherwise
+                    frontier_type = RainbowRenderer::FRONTIER_AUTO;
+                } else if (frontier_str == "scan") {
+                    // Linear scan over every edge
+                    frontier_type = RainbowRenderer::FRONTIER_SCAN;
+                } else if (frontier_str == "kdtree") {
+                    // Logarithmic, -d colour or natural
+                    frontier_type = RainbowRenderer::FRONTIER_KD_TREE;
+                } else if (frontier_str == "grid") {
+                    // Bucket grid, fastest when edge colours cluster; -d colour or natural
+                    frontier_type = RainbowRenderer::FRONTIER_GRID;
+                } else if (frontier_str == "vptree") {
+                    // Sublinear for every -d metric
+                    frontier_type = RainbowRenderer::FRONTIER_VP_TREE;
+                } else if (frontier_str == "sorted") {
+                    // Logarithmic, -d lum or hue
+                    frontier_type = RainbowRenderer::FRONTIER_SORTED;
+                } else if (frontier_str == "tiles") {
+                    // Board tiles pruned by colour bounds; -d colour or natural
+                    frontier_type = RainbowRenderer::FRONTIER_TILES;
+                } else if (frontier_str == "warm") {
+                    // Chunked scan seeded by the previous pick; best on sorted palettes
+                    frontier_type = RainbowRenderer::FRONTIER_WARM_START;
+                } else {
+                    std::cerr << "Unknown frontier type " << frontier_str << std::endl;
+                    return 1;
+                }
+                std::cout << "Setting frontier search to \"" << frontier_str << "\"" << std::endl;
+                rainbow_renderer.setFrontierType(frontier_type);
+                break;
+            }
+            case 'a': {
+                // Approximate edge search: fraction of placements that must match the exact pick
+                float recall;
+                try {
+                    recall = std::stof(optarg);
+                } catch (const std::exception &) {
+                    std::cerr << "Invalid recall target argument " << optarg << std::endl;
+                    return 1;
+                }
+
+                if (recall <= 0 || recall > 1.0) {
+                    std::cerr << "Recall target must be greater than 0 and at most 1" << std::endl;
+                    return 1;
+                }
+                std::cout << "Setting the approximate search recall target to " << recall << std::endl;
+                rainbow_renderer.setRecallTarget(recall);
+                break;
+            }
+            case 'b': {
+                // Board storage layout
+                std::string layout_str = optarg;
+                PixelBoard::Layout layout;
+                if (layout_str == "rows") {
+                    // Default: row by row
+                    layout = PixelBoard::LAYOUT_ROWS;
+                } else if (layout_str == "morton") {
+                    // 8x8 Z-ordered tiles, neighbours share cache lines
+                    layout = PixelBoard::LAYOUT_MORTON;
+                } else {
+                    std::cerr << "Unknown board layout " << layout_str << std::endl;
+                    return 1;
+                }
+                std::cout << "Setting board layout to \"" << layout_str << "\"" << std::endl;
+                rainbow_renderer.setBoardLayout(layout);
+                break;
+            }
+            case 'N': {
+                // Neighbours per pixel
+                const int neighbours = (int) strtol(optarg, nullptr, 0);
+                Connectivity connectivity;
+                if (neighbours == 8) {
+                    // Default: the surrounding square
+                    connectivity = CONNECTIVITY_8;
+                } else if (neighbours == 6) {
+                    // Hex grid
+                    connectivity = CONNECTIVITY_6;
+                } else if (neighbours == 4) {
+                    // Up, down, left and right only
+                    connectivity = CONNECTIVITY_4;
+                } else {
+                    std::cerr << "Neighbours per pixel must be 4, 6 or 8" << std::endl;
+                    return 1;
+                }
+                std::cout << "Setting neighbours per pixel to " << neighbours << std::endl;
+                rainbow_renderer.setConnectivity(connectivity);
+                break;
+            }
             case 'o': {
                 // Initial colour ordering
                 std::string colour_order_string = optarg;
@@ -310,6 +403,13 @@ int main(int argc, char *argv[]) {
                 std::cout << "Set " << positions.size() << " stripe positions" << std::endl;
                 break;
             }
+            case 'T': {
+                // File to keep the HSL table of every colour in, so runs after the first map it instead of
+                // building it
+                rainbow_renderer.setHslTablePath(optarg);
+                std::cout << "Keeping the HSL table in " << optarg << std::endl;
+                break;
+            }
             case 'B': {
                 // Seed at stripe boundaries (top+bottom edges) instead of centres.
                 // Only meaningful in stripe mode (used with -C and -P).
@@ -322,7 +422,8 @@ int main(int argc, char *argv[]) {
                     optopt == 'd' || optopt == 'r' || optopt == 'f' || optopt == 'o' ||
                     optopt == 'l' || optopt == 'L' || optopt == 's' || optopt == 'S' ||
                     optopt == 'p' || optopt == 'n' || optopt == 'F' || optopt == 'C' ||
-                    optopt == 'P') {
+                    optopt == 'P' || optopt == 'e' || optopt == 'a' || optopt == 'b' ||
+                    optopt == 'N' || optopt == 'T') {
                     std::cerr << "Option -" << char(optopt) << " requires an argument" << std::endl;
                 } else if (isprint(optopt)) {
                     std::cerr << "Unknown option -" << char(optopt) << std::endl;
@@ -0,0 +1,61 @@
+#ifndef RAINBOW_C_NEIGHBOUR_SUMMARY_H
+#define RAINBOW_C_NEIGHBOUR_SUMMARY_H
+
+#include <cstdint>
+#include <limits>
+
+#include "colour.h"
+#include "colour_bounds.h"
+
+/// The colours of an available point's filled neighbours, kept up to date
+/// as neighbours fill so neighbour_fill can score the point without walking
+/// the board.
+struct NeighbourSummary {
+    // Bit d is set when the neighbour in Neighbourhood direction d is
+    // filled, and colours[d] is then its colour. Room for up to 8.
+    std::uint8_t filled = 0;
+    Colour colours[8];
+    // Box around the filled neighbours' colours. Its lower bound is <= every
+    // neighbour's difference, and so <= their minimum and their mean.
+    ColourBounds bounds;
+
+    void setNeighbour(int direction, const Colour &colour) {
+        this->filled |= std::uint8_t(1u << direction);
+        this->colours[direction] = colour;
+        this->bounds.expand(colour);
+    }
+
+    /// The smallest, or with `Average` the mean, difference between `colour`
+    /// and the filled neighbours; FLT_MAX with none filled. This is the
+    /// neighbour fill's score. Neighbours are visited in direction order and
+    /// the mean is summed in double, so every caller gets the same floats.
+    /// `difference` is a ColourDifference or ColourDifferenceFunction.
+    template<bool Average, typename Difference>
+    float evaluate(const Difference &difference, const Colour &colour) const {
+        double sum = 0.0;
+        float min = std::numeric_limits<float>::max();
+        int count = 0;
+        for (int d = 0; d < 8; ++d) {
+            if (!(this->filled & (1u << d))) {
+                continue;
+            }
+            const float diff = difference(colour, this->colours[d]);
+            if constexpr (Average) {
+                sum += diff;
+            } else {
+                min = std::min(min, diff);
+            }
+            ++count;
+        }
+        if (count == 0) {
+            return std::numeric_limits<float>::max();
+        }
+        if constexpr (Average) {
+            return (float) (sum / float(count));
+        } else {
+            return min;
+        }
+    }
+};
+
+#endif //RAINBOW_C_NEIGHBOUR_SUMMARY_H
@@ -0,0 +1,89 @@
+#ifndef RAINBOW_C_NEIGHBOURHOOD_H
+#define RAINBOW_C_NEIGHBOURHOOD_H
+
+#include <cstdint>
+
+#include "point.h"
+
+/// Which pixels count as touching.
+enum Connectivity {
+    // Up, down, left and right.
+    CONNECTIVITY_4,
+    // A hex grid: odd rows sit half a pixel to the right, so each pixel
+    // touches two pixels above, two below, and one either side.
+    CONNECTIVITY_6,
+    // Every pixel in the surrounding 3x3 square.
+    CONNECTIVITY_8,
+};
+
+/// The neighbour offsets for a Connectivity, as compile-time tables.
+///
+/// offsets[y & 1][d] is the step to the neighbour in direction d from a
+/// pixel on row y; the two rows only differ on the hex grid. Directions are
+/// numbered so that direction count - 1 - d leads back again, on either row.
+template<Connectivity C>
+struct Neighbourhood;
+
+template<>
+struct Neighbourhood<CONNECTIVITY_4> {
+    static constexpr int count = 4;
+    static constexpr int offsets[2][count][2] = {
+        {{0, -1}, {-1, 0}, {1, 0}, {0, 1}},
+        {{0, -1}, {-1, 0}, {1, 0}, {0, 1}},
+    };
+};
+
+template<>
+struct Neighbourhood<CONNECTIVITY_6> {
+    static constexpr int count = 6;
+    static constexpr int offsets[2][count][2] = {
+        {{-1, -1}, {0, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}},
+        {{0, -1}, {1, -1}, {-1, 0}, {1, 0}, {0, 1}, {1, 1}},
+    };
+};
+
+/// Row by row, top to bottom, the order the neighbours were always visited
+/// in; edge_fill's random draws depend on it.
+template<>
+struct Neighbourhood<CONNECTIVITY_8> {
+    static constexpr int count = 8;
+    static constexpr int offsets[2][count][2] = {
+        {{-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1}},
+        {{-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1}},
+    };
+};
+
+/// The neighbour of `point` in direction `d` of neighbourhood `N`.
+template<typename N>
+inline Point neighbourOf(const Point &point, int d) {
+    const int (&offset)[2] = N::offsets[point.y & 1][d];
+    return Point(point.x + offset[0], point.y + offset[1]);
+}
+
+/// The direction that leads from a neighbour in direction `d` back again.
+template<typename N>
+constexpr int oppositeDirection(int d) {
+    return N::count - 1 - d;
+}
+
+/// Lookups over an 8-bit mask of neighbour directions: count[mask] is how
+/// many bits are set and select[mask][k] is the direction of the k-th one,
+/// lowest first.
+struct NeighbourMaskTable {
+    std::uint8_t count[256];
+    std::uint8_t select[256][8];
+
+    constexpr NeighbourMaskTable() : count(), select() {
+        for (int mask = 0; mask < 256; ++mask) {
+            for (int d = 0; d < 8; ++d) {
+                if (mask & (1 << d)) {
+                    this->select[mask][this->count[mask]++] = d;
+                }
+            }
+        }
+    }
+};
+
+constexpr NeighbourMaskTable kOpenNeighbours;
+
+#endif //RAINBOW_C_NEIGHBOURHOOD_H
@@ -0,0 +1,86 @@
+#include "palette.h"
+
+#include <algorithm>
+#include <numeric>
+
+void Palette::push(std::uint8_t r, std::uint8_t g, std::uint8_t b) {
+    this->rgb_.push_back((std::uint32_t(r) << 16) | (std::uint32_t(g) << 8) | std::uint32_t(b));
+    if (!this->hsl_.empty()) {
+        const auto t = rgbToHsl(r, g, b);
+        this->hsl_.push_back({std::get<0>(t), std::get<1>(t), std::get<2>(t)});
+    }
+}
+
+void Palette::append(const std::vector<std::uint32_t> &rgb) {
+    if (!this->hsl_.empty()) {
+        for (const std::uint32_t colour: rgb) {
+            this->push(std::uint8_t(colour >> 16), std::uint8_t(colour >> 8), std::uint8_t(colour));
+        }
+        return;
+    }
+    this->rgb_.insert(this->rgb_.end(), rgb.begin(), rgb.end());
+}
+
+void Palette::computeHsl() {
+    if (this->hsl_.size() == this->rgb_.size()) {
+        return;
+    }
+    this->hsl_.resize(this->rgb_.size());
+    for (std::size_t i = 0; i < this->rgb_.size(); ++i) {
+        const std::uint32_t rgb = this->rgb_[i];
+        const auto t = rgbToHsl(int(rgb >> 16), int((rgb >> 8) & 0xff), int(rgb & 0xff));
+        this->hsl_[i] = {std::get<0>(t), std::get<1>(t), std::get<2>(t)};
+    }
+}
+
+Colour Palette::at(std::size_t index) const {
+    const std::uint32_t rgb = this->rgb_[index];
+    Colour colour;
+    colour.r = int(rgb >> 16);
+    colour.g = int((rgb >> 8) & 0xff);
+    colour.b = int(rgb & 0xff);
+    if (!this->hsl_.empty()) {
+        colour.hue = this->hsl_[index].hue;
+        colour.sat = this->hsl_[index].sat;
+        colour.lum = this->hsl_[index].lum;
+    }
+    return colour;
+}
+
+void Palette::shuffle(std::default_random_engine &rng) {
+    if (this->hsl_.empty()) {
+        std::shuffle(this->rgb_.begin(), this->rgb_.end(), rng);
+        return;
+    }
+    // Shuffling positions makes the same swaps as shuffling the colours,
+    // and lets both arrays follow them.
+    std::vector<std::uint32_t> order(this->rgb_.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<std::uint32_t> rgb(order.size());
+    std::vector<Hsl> hsl(order.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        rgb[i] = this->rgb_[order[i]];
+        hsl[i] = this->hsl_[order[i]];
+    }
+    this->rgb_.swap(rgb);
+    this->hsl_.swap(hsl);
+}
+
+void Palette::sort(bool (*compare)(const Colour &, const Colour &), bool reverse) {
+    this->computeHsl();
+    std::vector<Colour> colours(this->rgb_.size());
+    for (std::size_t i = 0; i < colours.size(); ++i) {
+        colours[i] = this->at(i);
+    }
+    if (reverse) {
+        std::sort(colours.rbegin(), colours.rend(), compare);
+    } else {
+        std::sort(colours.begin(), colours.end(), compare);
+    }
+    for (std::size_t i = 0; i < colours.size(); ++i) {
+        const Colour &colour = colours[i];
+        this->rgb_[i] = (std::uint32_t(colour.r) << 16) | (std::uint32_t(colour.g) << 8) | std::uint32_t(colour.b);
+        this->hsl_[i] = {colour.hue, colour.sat, colour.lum};
+    }
+}
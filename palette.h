@@ -0,0 +1,62 @@
+#ifndef RAINBOW_C_PALETTE_H
+#define RAINBOW_C_PALETTE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "colour.h"
+
+/// The colours to be placed, in placement order.
+///
+/// Colours are stored packed as 0x00RRGGBB. Their hue, saturation and
+/// luminosity are only worked out when something asks for them, either
+/// computeHsl() or a sort on one of them, and are then kept in a side array.
+/// A -d colour fill with a random order never pays for HSL at all.
+class Palette {
+public:
+    std::size_t size() const { return this->rgb_.size(); }
+
+    bool empty() const { return this->rgb_.empty(); }
+
+    void reserve(std::size_t count) { this->rgb_.reserve(count); }
+
+    void push(std::uint8_t r, std::uint8_t g, std::uint8_t b);
+
+    void push(const Colour &colour) { this->push(colour.r, colour.g, colour.b); }
+
+    /// Pushes each of `rgb`, packed as 0x00RRGGBB, in order.
+    void append(const std::vector<std::uint32_t> &rgb);
+
+    /// Works out HSL for every colour, if not done already. After this the
+    /// Colours handed out by at() carry it.
+    void computeHsl();
+
+    /// The colour at `index`. Its hue, sat and lum are 0 unless computeHsl()
+    /// has run.
+    Colour at(std::size_t index) const;
+
+    /// Shuffles the colours, drawing from `rng` exactly as std::shuffle over
+    /// a std::vector<Colour> of the same size would.
+    void shuffle(std::default_random_engine &rng);
+
+    /// Sorts with `compare` (one of compareHue, compareSat or compareLum),
+    /// computing HSL first; with `reverse` the order is descending. The sort
+    /// runs over Colours exactly as it would on a std::vector<Colour>, so
+    /// the order, ties included, is the same.
+    void sort(bool (*compare)(const Colour &, const Colour &), bool reverse);
+
+private:
+    struct Hsl {
+        float hue;
+        float sat;
+        float lum;
+    };
+
+    std::vector<std::uint32_t> rgb_;
+    // Parallel to rgb_ once computeHsl() has run; empty before.
+    std::vector<Hsl> hsl_;
+};
+
+#endif //RAINBOW_C_PALETTE_H
@@ -0,0 +1,62 @@
+#include "pixel_board.h"
+
+void PixelBoard::resize(int width, int height, Layout layout) {
+    this->layout_ = layout;
+    this->width_ = width;
+    this->height_ = height;
+    this->stride_ = std::size_t(width) + 2;
+    this->tiles_wide_ = (this->stride_ + 7) / 8;
+    const std::size_t padded_height = std::size_t(height) + 2;
+    const std::size_t count = layout == LAYOUT_ROWS
+                                  ? this->stride_ * padded_height
+                                  : this->tiles_wide_ * ((padded_height + 7) / 8) * 64;
+    this->colours_.assign(count, 0);
+    this->filled_.assign((count + 63) / 64, 0);
+    this->available_.assign((count + 63) / 64, 0);
+
+    // Close off the ghost border.
+    const auto close = [this](int x, int y) {
+        const std::size_t index = this->indexOf(Point(x, y));
+        this->filled_[index / 64] |= std::uint64_t(1) << (index % 64);
+    };
+    for (int x = -1; x <= width; ++x) {
+        close(x, -1);
+        close(x, height);
+    }
+    for (int y = 0; y < height; ++y) {
+        close(-1, y);
+        close(width, y);
+    }
+}
+
+void PixelBoard::setAvailable(const Point &point, bool available) {
+    const std::size_t index = this->indexOf(point);
+    const std::uint64_t bit = std::uint64_t(1) << (index % 64);
+    if (available) {
+        this->available_[index / 64] |= bit;
+    } else {
+        this->available_[index / 64] &= ~bit;
+    }
+}
+
+void PixelBoard::fill(const Point &point, const Colour &colour) {
+    const std::size_t index = this->indexOf(point);
+    this->colours_[index] = (std::uint32_t(colour.r) << 16) | (std::uint32_t(colour.g) << 8) | std::uint32_t(colour.b);
+    this->filled_[index / 64] |= std::uint64_t(1) << (index % 64);
+}
+
+Colour PixelBoard::colourAt(const Point &point) const {
+    const std::uint32_t packed = this->packedAt(point);
+    return Colour(std::uint8_t(packed >> 16), std::uint8_t(packed >> 8), std::uint8_t(packed));
+}
+
+void PixelBoard::copyRgb(std::uint8_t *out) const {
+    for (int y = 0; y < this->height_; ++y) {
+        for (int x = 0; x < this->width_; ++x) {
+            const std::uint32_t packed = this->packedAt(Point(x, y));
+            *out++ = std::uint8_t(packed >> 16);
+            *out++ = std::uint8_t(packed >> 8);
+            *out++ = std::uint8_t(packed);
+        }
+    }
+}
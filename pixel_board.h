@@ -0,0 +1,97 @@
+#ifndef RAINBOW_C_PIXEL_BOARD_H
+#define RAINBOW_C_PIXEL_BOARD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "colour.h"
+#include "point.h"
+
+/// The canvas: each pixel's colour and whether it's filled or available.
+///
+/// Colours are stored packed as 0x00RRGGBB, and the two flags as bitplanes,
+/// so a pixel costs a little over 4 bytes. colourAt() rebuilds the full
+/// Colour (HSL included) from the RGB, which gives exactly the Colour that
+/// was stored since every Colour is built from its RGB.
+///
+/// Pixels are laid out either row by row or in 8x8 tiles, Z-ordered inside
+/// each tile. The tiled layout keeps a pixel's eight neighbours within a few
+/// cache lines (and usually one bitplane word) instead of three rows apart,
+/// at the cost of padding the board out to whole tiles.
+///
+/// The board is surrounded by a one pixel border of ghost cells, which count
+/// as filled but are never available and hold no colour. Any neighbour of an
+/// on-board pixel is then safe to look up, and an off-board neighbour just
+/// looks closed, so neighbour walks need no bounds checks.
+class PixelBoard {
+public:
+    enum Layout {
+        LAYOUT_ROWS,
+        LAYOUT_MORTON,
+    };
+
+    /// Sizes the board to `width` x `height` in the given layout, all pixels
+    /// empty.
+    void resize(int width, int height, Layout layout = LAYOUT_ROWS);
+
+    /// Position of `point`, on the board or in its ghost border, in the
+    /// board's storage: an index in [0, size()), for callers keeping their
+    /// own per-pixel data. Some indices are border or padding.
+    std::size_t indexOf(const Point &point) const {
+        const std::size_t x = std::size_t(point.x + 1);
+        const std::size_t y = std::size_t(point.y + 1);
+        if (this->layout_ == LAYOUT_ROWS) {
+            return y * this->stride_ + x;
+        }
+        const std::size_t tile = (y >> 3) * this->tiles_wide_ + (x >> 3);
+        return (tile << 6) | kMortonSpread[y & 7] << 1 | kMortonSpread[x & 7];
+    }
+
+    /// Whether `point` is on the board rather than in the ghost border.
+    bool contains(const Point &point) const {
+        return unsigned(point.x) < unsigned(this->width_) && unsigned(point.y) < unsigned(this->height_);
+    }
+
+    std::size_t size() const { return this->colours_.size(); }
+
+    /// True for filled pixels and for the ghost border.
+    bool isFilled(const Point &point) const { return test(this->filled_, this->indexOf(point)); }
+
+    bool isAvailable(const Point &point) const { return test(this->available_, this->indexOf(point)); }
+
+    void setAvailable(const Point &point, bool available);
+
+    /// Stores `colour` at `point` and marks it filled.
+    void fill(const Point &point, const Colour &colour);
+
+    /// The colour stored at `point`, or black if it isn't filled.
+    Colour colourAt(const Point &point) const;
+
+    /// The colour stored at `point` as 0x00RRGGBB.
+    std::uint32_t packedAt(const Point &point) const { return this->colours_[this->indexOf(point)]; }
+
+    /// Writes the board row by row as R, G, B bytes, width * height * 3 of
+    /// them, whatever the layout.
+    void copyRgb(std::uint8_t *out) const;
+
+private:
+    // Spreads the three bits of a tile coordinate over every other bit.
+    static constexpr std::uint8_t kMortonSpread[8] = {0, 1, 4, 5, 16, 17, 20, 21};
+
+    Layout layout_ = LAYOUT_ROWS;
+    int width_ = 0;
+    int height_ = 0;
+    // Padded row length, ghost cells included.
+    std::size_t stride_ = 0;
+    std::size_t tiles_wide_ = 0;
+    std::vector<std::uint32_t> colours_;
+    std::vector<std::uint64_t> filled_;
+    std::vector<std::uint64_t> available_;
+
+    static bool test(const std::vector<std::uint64_t> &plane, std::size_t index) {
+        return (plane[index / 64] >> (index % 64)) & 1u;
+    }
+};
+
+#endif //RAINBOW_C_PIXEL_BOARD_H
@@ -1,4 +1,13 @@
 #include "rainbow_renderer.h"
+#include "colour_bounds.h"
+#include "grid_frontier.h"
+#include "kd_tree_frontier.h"
+#include "neighbour_summary.h"
+#include "recall_controller.h"
+#include "sorted_frontier.h"
+#include "tile_frontier.h"
+#include "vp_tree_frontier.h"
+#include "warm_start_frontier.h"
 
 // stb_image_write is a single-header library — the implementation is
 // only compiled where STB_IMAGE_WRITE_IMPLEMENTATION is defined before
@@ -9,12 +18,14 @@
 #include <cmath>
 #include <cstdint>
 #include <limits>
-#include <set>
 #include <sstream>
 #include <stdexcept>
 
 constexpr double PI = 3.14159265358979323846;
 
+// Every 8-bit RGB colour.
+constexpr std::uint32_t kCubeColours = 1u << 24;
+
 void RainbowRenderer::setSeed(unsigned int _seed) {
     this->seed = _seed;
 }
@@ -51,6 +62,22 @@ void RainbowRenderer::setFillMode(FillMode _fill_mode) {
     this->fill_mode = _fill_mode;
 }
 
+void RainbowRenderer::setFrontierType(FrontierType _frontier_type) {
+    this->frontier_type = _frontier_type;
+}
+
+void RainbowRenderer::setBoardLayout(PixelBoard::Layout layout) {
+    this->board_layout = layout;
+}
+
+void RainbowRenderer::setConnectivity(Connectivity _connectivity) {
+    this->connectivity = _connectivity;
+}
+
+void RainbowRenderer::setRecallTarget(float recall) {
+    this->recall_target = recall;
+}
+
 void RainbowRenderer::addColourOrder(ColourOrdering ordering) {
     this->colour_ordering.push_back(ordering);
 }
@@ -87,14 +114,61 @@ void RainbowRenderer::setMaximumSaturation(float saturation) {
     this->maximumSaturation = saturation;
 }
 
+void RainbowRenderer::setHslTablePath(const std::string &path) {
+    this->hsl_table_path = path;
+}
+
+namespace {
+    /// Colours packed as 0x00RRGGBB, as the palette sweeps collect them.
+    using PackedColours = std::vector<std::uint32_t>;
+
+    /// Joins two chunks' colours, the later chunk's after the earlier's, so
+    /// a parallel sweep gives its colours in the same order a serial one
+    /// would.
+    PackedColours joinColours(PackedColours left, const PackedColours &right) {
+        left.insert(left.end(), right.begin(), right.end());
+        return left;
+    }
+
+    /// Combines two chunks' or shards' closest matches, a tie going to the
+    /// lower index.
+    ColourMatch closerMatch(const ColourMatch &left, const ColourMatch &right) {
+        if (right.difference < left.difference ||
+            (right.difference == left.difference && right.index < left.index)) {
+            return right;
+        }
+        return left;
+    }
+}
+
 /// Initialises starting pixels
 void RainbowRenderer::init() {
+    if (this->recall_target.has_value() && this->fill_mode != FILL_MODE_EDGE) {
+        // Only edge_fill loosens its search; the neighbour fills are exact.
+        throw std::runtime_error("Approximate search (-a) only applies to -f edge");
+    }
     this->rng = std::default_random_engine(this->seed);
-    this->pixels.resize(this->pixels_wide * this->pixels_high);
+    this->board.resize(this->pixels_wide, this->pixels_high, this->board_layout);
+    this->edge_slots.assign(this->board.size(), kNotAnEdge);
+    if (this->fill_mode == FILL_MODE_EDGE) {
+        // Must exist before the first pushEdge below so it sees every edge.
+        this->frontier_index = this->makeFrontierIndex();
+        const ColourMetric metric = getColourMetric(this->difference_function);
+        if (!this->frontier_index && FrontierBuffer::supports(metric)) {
+            this->frontier_buffer = std::make_unique<FrontierBuffer>(metric, this->thread_pool_.num_workers());
+            std::cout << "Scanning the frontier with " << colourBatchInstructionSet() << " kernels" << std::endl;
+        }
+    }
 
     // Compute colours up front: in stripe mode this also reserves per-stripe
     // seed rows in stripeSeeds, which we consume below.
     this->fillColours();
+    // The palette only carries HSL once something asks for it; the hue and
+    // luminosity metrics (and unknown ones, which may read anything) do.
+    const ColourMetric palette_metric = getColourMetric(this->difference_function);
+    if (palette_metric != COLOUR_METRIC_ABSOLUTE && palette_metric != COLOUR_METRIC_NATURAL) {
+        this->colours.computeHsl();
+    }
 
     // Stripe mode short-circuits the normal start_type logic — each stripe
     // gets one seed row at its centre (default) or two seed rows at its
@@ -128,10 +202,8 @@ void RainbowRenderer::init() {
                 const std::size_t seed_offset = row * this->pixels_wide;
                 for (int x = 0; x < this->pixels_wide; ++x) {
                     Point p(x, y);
-                    Pixel *pixel = this->getPixelAtPoint(p);
-                    pixel->colour = seeds[seed_offset + x];
-                    pixel->is_filled = true;
-                    this->pushEdge(p);
+                    this->board.fill(p, seeds[seed_offset + x]);
+                    this->pushEdge(p, seeds[seed_offset + x]);
                 }
                 std::cout << "Seeded stripe " << i << " at y=" << y
                         << " (" << this->pixels_wide << " pixels)" << std::endl;
@@ -250,132 +322,201 @@ void RainbowRenderer::fill() {
     }
 }
 
+template<typename F>
+void RainbowRenderer::withNeighbourhood(F &&f) const {
+    switch (this->connectivity) {
+        case CONNECTIVITY_4:
+            f(Neighbourhood<CONNECTIVITY_4>());
+            break;
+        case CONNECTIVITY_6:
+            f(Neighbourhood<CONNECTIVITY_6>());
+            break;
+        case CONNECTIVITY_8:
+            f(Neighbourhood<CONNECTIVITY_8>());
+            break;
+    }
+}
+
 /// Fills remaining spaces with pixels
 void RainbowRenderer::edge_fill() {
+    this->withNeighbourhood([this](auto neighbourhood) {
+        this->edgeFillWith<decltype(neighbourhood)>();
+    });
+}
+
+template<typename N>
+void RainbowRenderer::edgeFillWith() {
     const int total_pixels = this->pixels_high * this->pixels_wide;
     const int save_partition = this->num_intermediate_frames > 0
                                    ? total_pixels / this->num_intermediate_frames
                                    : 0;
     const int progress_partition = total_pixels < 100 ? 1 : total_pixels / 100;
 
-    // Per-worker scratch for the parallel min-reduction. Allocated once
-    // outside the loop so the scan doesn't reallocate on every placement.
-    // Sized to num_workers(); each worker writes only its own slot.
-    std::vector<std::size_t> local_best_index(thread_pool_.num_workers(), 0);
-    std::vector<float> local_best_diff(thread_pool_.num_workers(),
-                                       std::numeric_limits<float>::max());
+    std::optional<RecallController> recall;
+    if (this->recall_target.has_value()) {
+        recall.emplace(*this->recall_target);
+    }
+
+    // Bit d of a pixel's entry is set while its neighbour in direction d is
+    // on the board and unfilled. An edge whose mask reaches 0 is surrounded.
+    std::vector<std::uint8_t> open(this->board.size(), 0);
+    for (int y = 0; y < this->pixels_high; ++y) {
+        for (int x = 0; x < this->pixels_wide; ++x) {
+            const Point point(x, y);
+            std::uint8_t mask = 0;
+            for (int d = 0; d < N::count; ++d) {
+                if (!this->board.isFilled(neighbourOf<N>(point, d))) {
+                    mask |= std::uint8_t(1u << d);
+                }
+            }
+            open[this->board.indexOf(point)] = mask;
+        }
+    }
 
     while (true) {
         if (this->available_edges.empty() || this->colour_index >= this->colours.size()) {
             std::cout << "Out of edges or colours" << std::endl;
             break;
         }
-        const Colour &current_colour = this->colours[this->colour_index];
-
-        // Reset slots to the "no result" sentinel. Workers that get a chunk
-        // overwrite their slot; workers that don't (when available_edges is
-        // smaller than num_workers()) lose the final reduction comparison.
-        std::fill(local_best_diff.begin(), local_best_diff.end(),
-                  std::numeric_limits<float>::max());
-
-        thread_pool_.parallel_range(this->available_edges.size(),
-                                    [&](std::size_t worker_id, std::size_t start, std::size_t end) {
-                                        // Each worker scans its own chunk [start, end) and records
-                                        // the local minimum in its dedicated slot. No locking needed
-                                        // because slots are per-worker.
-                                        std::size_t bi = start;
-                                        float bd = this->difference_function(
-                                            current_colour,
-                                            this->getPixelAtPoint(this->available_edges[start])->colour);
-                                        for (std::size_t i = start + 1; i < end; ++i) {
-                                            float d = this->difference_function(
-                                                current_colour,
-                                                this->getPixelAtPoint(this->available_edges[i])->colour);
-                                            if (d < bd) {
-                                                bd = d;
-                                                bi = i;
-                                            }
-                                        }
-                                        local_best_index[worker_id] = bi;
-                                        local_best_diff[worker_id] = bd;
-                                    });
-
-        // Sequential reduce over per-worker locals. N is tiny (num CPU
-        // cores), so this is essentially free.
-        std::size_t best_index = local_best_index[0];
-        float best_difference = local_best_diff[0];
-        for (std::size_t w = 1; w < thread_pool_.num_workers(); ++w) {
-            if (local_best_diff[w] < best_difference) {
-                best_difference = local_best_diff[w];
-                best_index = local_best_index[w];
+        const Colour current_colour = this->colours.at(this->colour_index);
+
+        std::size_t best_index;
+        if (this->frontier_index) {
+            best_index = this->frontier_index->nearest(current_colour,
+                                                       recall ? recall->approximation() : 0.0f);
+            if (recall && recall->shouldAudit(this->colour_index)) {
+                const std::size_t exact_index = this->frontier_index->nearest(current_colour, 0.0f);
+                recall->recordAudit(
+                    exact_index == best_index,
+                    this->difference_function(current_colour,
+                                              this->board.colourAt(this->available_edges[best_index])),
+                    this->difference_function(current_colour,
+                                              this->board.colourAt(this->available_edges[exact_index])));
             }
+        } else if (this->frontier_buffer) {
+            // Each thread scans the shard of the frontier it owns for its
+            // own closest edge. Shards report slots, so the tie-break is on
+            // the slot, as a single scan would be.
+            best_index = thread_pool_.parallel_shards<ColourMatch>(
+                this->frontier_buffer->shardCount(), this->frontier_buffer->size(),
+                [&](std::size_t shard) {
+                    return this->frontier_buffer->nearest(current_colour, shard);
+                },
+                closerMatch).index;
+        } else {
+            // Each chunk of the frontier is scanned for its own closest
+            // edge; chunks are combined in order, so a tie keeps the
+            // earlier (lower) slot, as a single scan would.
+            best_index = thread_pool_.parallel_reduce<ColourMatch>(
+                this->available_edges.size(),
+                [&](std::size_t start, std::size_t end) {
+                    ColourMatch best{start, this->difference_function(
+                                                current_colour, this->board.colourAt(this->available_edges[start]))};
+                    for (std::size_t i = start + 1; i < end; ++i) {
+                        const float d = this->difference_function(
+                            current_colour, this->board.colourAt(this->available_edges[i]));
+                        if (d < best.difference) {
+                            best = {i, d};
+                        }
+                    }
+                    return best;
+                },
+                closerMatch).index;
         }
         Point best_point = this->available_edges[best_index];
 
-        auto neighbours = getNeighboursOfPoint(best_point);
-        int neighbour_count = (int) neighbours.size();
-        std::shuffle(std::begin(neighbours), std::end(neighbours), this->rng);
-        int neighbour_index = 0;
-        for (; neighbour_index < neighbour_count; ++neighbour_index) {
-            Point &neighbour = neighbours[neighbour_index];
-            Pixel *const neighbour_pixel = getPixelAtPoint(neighbour);
-            if (neighbour_pixel->is_filled) {
+        const std::uint8_t best_open = open[this->board.indexOf(best_point)];
+        if (best_open == 0) {
+            // Best-point was already surrounded when we picked it. Incremental
+            // cleanup normally catches this, but starting points placed
+            // adjacent to each other in fillPoint can slip through — one may
+            // be surrounded before any fill has run.
+            this->popEdge(best_index);
+            continue;
+        }
+
+        // Fill one of best_point's open neighbours, picked at random.
+        const int pick = std::uniform_int_distribution<int>(0, kOpenNeighbours.count[best_open] - 1)(this->rng);
+        const Point neighbour = neighbourOf<N>(best_point, kOpenNeighbours.select[best_open][pick]);
+        this->board.fill(neighbour, current_colour);
+        ++this->colour_index;
+
+        // Incremental cleanup: the only edges whose open neighbours just
+        // changed are the neighbours of `neighbour` itself. Any that just
+        // ran out are popped in O(1). Ghost cells start with no open
+        // neighbours, so they never run out.
+        for (int d = 0; d < N::count; ++d) {
+            const Point m = neighbourOf<N>(neighbour, d);
+            std::uint8_t &m_open = open[this->board.indexOf(m)];
+            if (m_open == 0) {
                 continue;
             }
-            neighbour_pixel->colour = current_colour;
-            neighbour_pixel->is_filled = true;
-            this->pushEdge(neighbour);
-            ++this->colour_index;
-
-            // Incremental cleanup: the only edges whose unfilled-neighbour
-            // count just dropped are the filled neighbours of `neighbour`
-            // itself. Any that became fully surrounded are popped in O(1).
-            // Skip `neighbour` — it was just added by pushEdge above and we
-            // don't want to check it against itself.
-            for (const Point &m: this->getNeighboursOfPoint(neighbour)) {
-                Pixel *m_pixel = this->getPixelAtPoint(m);
-                if (m_pixel->edge_index < 0) {
-                    continue;
-                }
-                bool has_open = false;
-                for (const Point &mn: this->getNeighboursOfPoint(m)) {
-                    if (!this->getPixelAtPoint(mn)->is_filled) {
-                        has_open = true;
-                        break;
-                    }
-                }
-                if (!has_open) {
-                    this->popEdge(static_cast<std::size_t>(m_pixel->edge_index));
+            m_open &= std::uint8_t(~(1u << oppositeDirection<N>(d)));
+            if (m_open == 0) {
+                const std::uint32_t m_slot = this->edge_slots[this->board.indexOf(m)];
+                if (m_slot != kNotAnEdge) {
+                    this->popEdge(m_slot);
                 }
             }
-
-            if (this->colour_index % progress_partition == 0) {
-                std::cout << "Step " << this->colour_index << " with " << this->available_edges.size() << " edges ("
-                        << ((float) this->colour_index / float(total_pixels) * 100)
-                        << "%)"
-                        << std::endl;
-            }
-            if (save_partition > 0 && this->colour_index % save_partition == 0) {
-                std::ostringstream stream;
-                stream << "output_" << int(this->colour_index / save_partition) << ".png";
-                std::cout << "Saving... " << std::flush;
-                this->writeToFile(stream.str());
-                std::cout << "Done" << std::endl;
-            }
-            break;
+        }
+        if (open[this->board.indexOf(neighbour)] != 0) {
+            this->pushEdge(neighbour, current_colour);
         }
 
-        if (neighbour_index == neighbour_count) {
-            // Best-point was already surrounded when we picked it. Incremental
-            // cleanup normally catches this, but starting points placed
-            // adjacent to each other in fillPoint can slip through — one may
-            // be surrounded before any fill has run.
-            this->popEdge(best_index);
+        if (this->colour_index % progress_partition == 0) {
+            std::cout << "Step " << this->colour_index << " with " << this->available_edges.size() << " edges ("
+                    << ((float) this->colour_index / float(total_pixels) * 100)
+                    << "%)"
+                    << std::endl;
+        }
+        if (save_partition > 0 && this->colour_index % save_partition == 0) {
+            std::ostringstream stream;
+            stream << "output_" << int(this->colour_index / save_partition) << ".png";
+            std::cout << "Saving... " << std::flush;
+            this->writeToFile(stream.str());
+            std::cout << "Done" << std::endl;
         }
     }
+
+    if (recall) {
+        recall->report(std::cout);
+    }
 }
 
 void RainbowRenderer::neighbour_fill(bool neighbour_average) {
+    // Pick the specialisation once, so the placement loop never calls
+    // through difference_function for the built-in metrics.
+    const auto fillWith = [&](const auto &difference) {
+        this->withNeighbourhood([&](auto neighbourhood) {
+            using N = decltype(neighbourhood);
+            if (neighbour_average) {
+                this->neighbourFillWith<true, N>(difference);
+            } else {
+                this->neighbourFillWith<false, N>(difference);
+            }
+        });
+    };
+    switch (getColourMetric(this->difference_function)) {
+        case COLOUR_METRIC_ABSOLUTE:
+            fillWith(ColourDifference<COLOUR_METRIC_ABSOLUTE>());
+            break;
+        case COLOUR_METRIC_NATURAL:
+            fillWith(ColourDifference<COLOUR_METRIC_NATURAL>());
+            break;
+        case COLOUR_METRIC_HUE:
+            fillWith(ColourDifference<COLOUR_METRIC_HUE>());
+            break;
+        case COLOUR_METRIC_LUMINOSITY:
+            fillWith(ColourDifference<COLOUR_METRIC_LUMINOSITY>());
+            break;
+        default:
+            fillWith(ColourDifferenceFunction{this->difference_function});
+            break;
+    }
+}
+
+template<bool Average, typename N, typename Difference>
+void RainbowRenderer::neighbourFillWith(const Difference &difference) {
     const int total_pixels = this->pixels_high * this->pixels_wide;
     const int save_partition = this->num_intermediate_frames > 0
                                    ? total_pixels / this->num_intermediate_frames
@@ -383,85 +524,168 @@ void RainbowRenderer::neighbour_fill(bool neighbour_average) {
     const int progress_partition = total_pixels < 100 ? 1 : total_pixels / 100;
     // List of places where pixels can be placed (next to neighbours)
     std::vector<Point> availablePoints;
-    // Find all neighbours of existing points and add them to the available list
+    // The filled neighbours of each entry in availablePoints, kept in step
+    // with it. Scoring a point only reads its summary, so the scan never
+    // walks the board or allocates.
+    std::vector<NeighbourSummary> summaries;
+    // Position of each pixel in availablePoints, or -1 if it isn't there.
+    std::vector<int> available_index(this->board.size(), -1);
+
+    const auto makeAvailable = [&](const Point &point) {
+        this->board.setAvailable(point, true);
+        available_index[this->board.indexOf(point)] = static_cast<int>(availablePoints.size());
+        availablePoints.push_back(point);
+        summaries.emplace_back();
+    };
+
+    // Find all neighbours of existing points, add them to the available
+    // list and tell them about the filled point. From the neighbour's side,
+    // the filled point lies in the opposite direction.
     for (int y = 0; y < this->pixels_high; ++y) {
         for (int x = 0; x < this->pixels_wide; ++x) {
-            Point point = Point(x, y);
-            Pixel *pixel = this->getPixelAtPoint(point);
-            if (!pixel->is_filled) {
+            const Point point(x, y);
+            if (!this->board.isFilled(point)) {
                 continue;
             }
-            for (auto neighbour: this->getNeighboursOfPoint(point)) {
-                Pixel *neighbour_pixel = this->getPixelAtPoint(neighbour);
-                if (!neighbour_pixel->is_filled && !neighbour_pixel->is_available) {
-                    neighbour_pixel->is_available = true;
-                    availablePoints.push_back(neighbour);
+            const Colour colour = this->board.colourAt(point);
+            for (int d = 0; d < N::count; ++d) {
+                const Point neighbour = neighbourOf<N>(point, d);
+                if (this->board.isFilled(neighbour)) {
+                    continue;
                 }
+                if (!this->board.isAvailable(neighbour)) {
+                    makeAvailable(neighbour);
+                }
+                summaries[available_index[this->board.indexOf(neighbour)]]
+                        .setNeighbour(oppositeDirection<N>(d), colour);
             }
         }
     }
 
-    // Per-worker scratch for the parallel min-reduction — allocated once
-    // outside the placement loop so the scan doesn't reallocate every
-    // iteration. Same pattern as edge_fill.
-    std::vector<std::size_t> local_best_index(thread_pool_.num_workers(), 0);
-    std::vector<float> local_best_diff(thread_pool_.num_workers(),
-                                       std::numeric_limits<float>::max());
+    // In closest-neighbour mode a point's score is its smallest difference
+    // to any filled neighbour, so the best point is the one owning the
+    // closest (point, filled neighbour) pair. An index over those pairs
+    // answers that directly; pair slots are 8 * point index + direction,
+    // so the lowest-slot tie is also the lowest point index, as in the scan.
+    std::unique_ptr<FrontierIndex> pair_index = Average ? nullptr : this->makeFrontierIndex();
+    if (pair_index) {
+        for (std::size_t i = 0; i < availablePoints.size(); ++i) {
+            for (int d = 0; d < N::count; ++d) {
+                if (summaries[i].filled & (1u << d)) {
+                    pair_index->insert(8 * i + d, availablePoints[i], summaries[i].colours[d]);
+                }
+            }
+        }
+    }
+
+    // Average mode is searched branch-and-bound when the metric can be
+    // bounded by a box: a candidate is only scored exactly when the lower
+    // bound from its summary's box is no worse than the best score so far.
+    constexpr bool bounded_average = Average && (Difference::metric == COLOUR_METRIC_ABSOLUTE ||
+                                                 Difference::metric == COLOUR_METRIC_NATURAL);
+    std::vector<float> lower_bounds;
 
     // While there are colours to place and available spots to place them
     for (; this->colour_index < this->colours.size() && !availablePoints.empty(); ++this->colour_index) {
-        Colour &colour = this->colours[colour_index];
-
-        // Reset the diff slots so workers that don't get a chunk (when
-        // availablePoints is smaller than num_workers()) lose the reduce.
-        std::fill(local_best_diff.begin(), local_best_diff.end(),
-                  std::numeric_limits<float>::max());
-
-        thread_pool_.parallel_range(availablePoints.size(),
-                                    [&](std::size_t worker_id, std::size_t start, std::size_t end) {
-                                        // Same structure as edge_fill's parallel scan, but the
-                                        // per-candidate cost is `getNeighbourDifference` which
-                                        // itself walks each candidate's neighbours. Safe to call
-                                        // concurrently: it only reads pixel state, and no writes
-                                        // to pixels happen until AFTER the reduction below.
-                                        std::size_t bi = start;
-                                        float bd = this->getNeighbourDifference(
-                                            availablePoints[start], colour, neighbour_average);
-                                        for (std::size_t i = start + 1; i < end; ++i) {
-                                            float d = this->getNeighbourDifference(
-                                                availablePoints[i], colour, neighbour_average);
-                                            if (d < bd) {
-                                                bd = d;
-                                                bi = i;
-                                            }
-                                        }
-                                        local_best_index[worker_id] = bi;
-                                        local_best_diff[worker_id] = bd;
-                                    });
-
-        // Sequential reduction across per-worker locals.
-        std::size_t best_index = local_best_index[0];
-        float best_difference = local_best_diff[0];
-        for (std::size_t w = 1; w < thread_pool_.num_workers(); ++w) {
-            if (local_best_diff[w] < best_difference) {
-                best_difference = local_best_diff[w];
-                best_index = local_best_index[w];
-            }
+        const Colour colour = this->colours.at(this->colour_index);
+
+        std::size_t best_index;
+        if (pair_index) {
+            best_index = pair_index->nearest(colour, 0.0f) / 8;
+        } else if (bounded_average) {
+            // Each chunk seeds with its candidate whose bound is lowest, then
+            // only scores the ones whose bound doesn't already exceed its
+            // best so far. Chunks write their own slices of lower_bounds.
+            lower_bounds.resize(availablePoints.size());
+            best_index = thread_pool_.parallel_reduce<ColourMatch>(
+                availablePoints.size(),
+                [&](std::size_t start, std::size_t end) {
+                    std::size_t seed = start;
+                    for (std::size_t i = start; i < end; ++i) {
+                        lower_bounds[i] = summaries[i].bounds.lowerBound<Difference::metric>(colour);
+                        if (lower_bounds[i] < lower_bounds[seed]) {
+                            seed = i;
+                        }
+                    }
+
+                    ColourMatch best{seed, summaries[seed].evaluate<true>(difference, colour)};
+                    for (std::size_t i = start; i < end; ++i) {
+                        // Strictly greater: an equal bound could still be a
+                        // lower-index tie, which the exhaustive scan would pick.
+                        if (i == seed || lower_bounds[i] > best.difference) {
+                            continue;
+                        }
+                        const float d = summaries[i].evaluate<true>(difference, colour);
+                        if (d < best.difference || (d == best.difference && i < best.index)) {
+                            best = {i, d};
+                        }
+                    }
+                    return best;
+                },
+                closerMatch).index;
+        } else {
+            // Same reduction as edge_fill's scan, scoring each candidate
+            // from its neighbour summary. Safe to run concurrently:
+            // summaries are only read here, and aren't written until after.
+            best_index = thread_pool_.parallel_reduce<ColourMatch>(
+                availablePoints.size(),
+                [&](std::size_t start, std::size_t end) {
+                    ColourMatch best{start, summaries[start].evaluate<Average>(difference, colour)};
+                    for (std::size_t i = start + 1; i < end; ++i) {
+                        const float d = summaries[i].evaluate<Average>(difference, colour);
+                        if (d < best.difference) {
+                            best = {i, d};
+                        }
+                    }
+                    return best;
+                },
+                closerMatch).index;
         }
         Point best_point = availablePoints[best_index];
 
-        Pixel *pixel = this->getPixelAtPoint(best_point);
-        pixel->is_filled = true;
-        pixel->is_available = false;
-        pixel->colour = colour;
-        availablePoints[best_index] = availablePoints.back();
+        this->board.fill(best_point, colour);
+        this->board.setAvailable(best_point, false);
+        available_index[this->board.indexOf(best_point)] = -1;
+        if (pair_index) {
+            // Mirror the swap-pop below: drop best_point's pairs, then
+            // renumber the last point's pairs into its position.
+            const std::size_t last = availablePoints.size() - 1;
+            for (int d = 0; d < N::count; ++d) {
+                if (summaries[best_index].filled & (1u << d)) {
+                    pair_index->remove(8 * best_index + d);
+                }
+            }
+            for (int d = 0; d < N::count; ++d) {
+                if (best_index != last && (summaries[last].filled & (1u << d))) {
+                    pair_index->move(8 * last + d, 8 * best_index + d);
+                }
+            }
+        }
+        if (best_index != availablePoints.size() - 1) {
+            availablePoints[best_index] = availablePoints.back();
+            summaries[best_index] = summaries.back();
+            const Point &moved = availablePoints[best_index];
+            available_index[this->board.indexOf(moved)] = static_cast<int>(best_index);
+        }
         availablePoints.pop_back();
-
-        for (auto neighbour: this->getNeighboursOfPoint(best_point)) {
-            Pixel *neighbourPixel = this->getPixelAtPoint(neighbour);
-            if (!neighbourPixel->is_filled && !neighbourPixel->is_available) {
-                neighbourPixel->is_available = true;
-                availablePoints.push_back(neighbour);
+        summaries.pop_back();
+
+        // Tell every unfilled neighbour about its new filled neighbour,
+        // making it available first if it wasn't already. From the
+        // neighbour's side, best_point lies in the opposite direction.
+        for (int d = 0; d < N::count; ++d) {
+            const Point neighbour = neighbourOf<N>(best_point, d);
+            if (this->board.isFilled(neighbour)) {
+                continue;
+            }
+            if (!this->board.isAvailable(neighbour)) {
+                makeAvailable(neighbour);
+            }
+            const std::size_t index = available_index[this->board.indexOf(neighbour)];
+            const int opposite = oppositeDirection<N>(d);
+            summaries[index].setNeighbour(opposite, colour);
+            if (pair_index) {
+                pair_index->insert(8 * index + opposite, neighbour, colour);
             }
         }
 
@@ -482,79 +706,86 @@ void RainbowRenderer::neighbour_fill(bool neighbour_average) {
     }
 }
 
-float RainbowRenderer::getNeighbourDifference(Point point, const Colour &colour, bool neighbour_average) {
-    std::vector<float> diffs;
-    for (auto neighbour: this->getNeighboursOfPoint(point)) {
-        const Pixel *pixel = this->getPixelAtPoint(neighbour);
-        if (!pixel->is_filled) {
-            continue;
-        }
-        float diff = this->difference_function(colour, pixel->colour);
-        diffs.push_back(diff);
-    }
-    if (diffs.empty()) {
-        return std::numeric_limits<float>::max();
-    }
-
-    if (neighbour_average) {
-        return (float) (std::accumulate(diffs.begin(), diffs.end(), 0.0) / float(diffs.size()));
-    }
-    return *std::min_element(diffs.begin(), diffs.end());
-}
-
-
 /// Writes the current content of the pixel board out to file
 /// \param _filename
 void RainbowRenderer::writeToFile(const std::string &_filename) {
     // stb_image_write expects a contiguous byte buffer, top-to-bottom,
-    // 3 bytes per pixel in R, G, B order. Colour channels are stored as
-    // int (0..255) on our side; narrow to uint8_t for the buffer.
+    // 3 bytes per pixel in R, G, B order; the board linearises its own
+    // layout into one.
     std::vector<uint8_t> buffer(static_cast<std::size_t>(this->pixels_wide)
                                 * this->pixels_high * 3);
-    for (int y = 0; y < this->pixels_high; ++y) {
-        for (int x = 0; x < this->pixels_wide; ++x) {
-            const Pixel *pixel = getPixel(x, y);
-            const std::size_t idx =
-                    (static_cast<std::size_t>(y) * this->pixels_wide + x) * 3;
-            buffer[idx + 0] = static_cast<uint8_t>(pixel->colour.r);
-            buffer[idx + 1] = static_cast<uint8_t>(pixel->colour.g);
-            buffer[idx + 2] = static_cast<uint8_t>(pixel->colour.b);
-        }
-    }
+    this->board.copyRgb(buffer.data());
     stbi_write_png(_filename.c_str(),
                    this->pixels_wide, this->pixels_high, 3, buffer.data(), this->pixels_wide * 3);
 }
 
-Pixel *RainbowRenderer::getPixel(int x, int y) {
-    return &this->pixels[y * this->pixels_wide + x];
-}
-
-/// Gets the pixel at the given point
-/// \param point The point
-/// \return The pixel at that point
-Pixel *RainbowRenderer::getPixelAtPoint(const Point &point) {
-    return &this->pixels[point.y * this->pixels_wide + point.x];
-}
-
-/// Gets the neighbour positions of the given point (points over the edge of the board aren ot returned)
-/// \param point The point to find the neighbours for
-/// \return The number of neighbours
-std::vector<Point> RainbowRenderer::getNeighboursOfPoint(const Point &point) const {
-    std::vector<Point> neighbours;
-    for (int y = -1; y <= 1; ++y) {
-        if (y + point.y < 0 || y + point.y >= this->pixels_high) {
-            continue;
+std::unique_ptr<FrontierIndex> RainbowRenderer::makeFrontierIndex() const {
+    const ColourMetric metric = getColourMetric(this->difference_function);
+    FrontierType type = this->frontier_type;
+    if (type == FRONTIER_AUTO) {
+        if (SortedFrontier::supports(metric)) {
+            type = FRONTIER_SORTED;
+        } else if (this->fill_mode == FILL_MODE_NEIGHBOUR && ColourBounds::canBound(metric)) {
+            // Closest-neighbour mode indexes 8 pairs per available point and
+            // scores them through several calls each, so it gains far more
+            // from an index than edge_fill does.
+            type = FRONTIER_KD_TREE;
+        } else {
+            type = FRONTIER_SCAN;
         }
-
-        for (int x = -1; x <= 1; ++x) {
-            if ((x == 0 && y == 0) || x + point.x < 0 || x + point.x >= this->pixels_wide) {
-                continue;
-            }
-
-            neighbours.emplace_back(x + point.x, y + point.y);
+    }
+    if (this->recall_target.has_value() && (type == FRONTIER_SCAN || type == FRONTIER_SORTED)) {
+        // Approximation works by loosening an index's pruning, so there has
+        // to be an index that prunes; the sorted one is always exact. An
+        // explicit -e scan or -e sorted rules that out; otherwise take the
+        // VP-tree, which handles every metric.
+        if (this->frontier_type == FRONTIER_SCAN) {
+            throw std::runtime_error("Approximate search (-a) needs a frontier index, so can't use -e scan");
+        }
+        if (this->frontier_type == FRONTIER_SORTED) {
+            throw std::runtime_error("Approximate search (-a) can't loosen the exact -e sorted frontier");
         }
+        std::cout << "Approximate search needs a frontier index that can approximate, using vptree"
+                  << std::endl;
+        type = FRONTIER_VP_TREE;
+    }
+    switch (type) {
+        case FRONTIER_AUTO:
+        case FRONTIER_SCAN:
+            return nullptr;
+        case FRONTIER_KD_TREE:
+            if (!ColourBounds::canBound(metric)) {
+                throw std::runtime_error("The kdtree frontier only supports -d colour and -d natural");
+            }
+            return std::make_unique<KdTreeFrontier>(this->difference_function);
+        case FRONTIER_GRID:
+            if (!ColourBounds::canBound(metric)) {
+                throw std::runtime_error("The grid frontier only supports -d colour and -d natural");
+            }
+            return std::make_unique<GridFrontier>(this->difference_function);
+        case FRONTIER_VP_TREE:
+            if (metric == COLOUR_METRIC_UNKNOWN) {
+                throw std::runtime_error("The vptree frontier needs one of the built-in -d metrics");
+            }
+            return std::make_unique<VpTreeFrontier>(this->difference_function);
+        case FRONTIER_SORTED:
+            if (!SortedFrontier::supports(metric)) {
+                throw std::runtime_error("The sorted frontier only supports -d lum and -d hue");
+            }
+            return std::make_unique<SortedFrontier>(this->difference_function);
+        case FRONTIER_TILES:
+            if (!ColourBounds::canBound(metric)) {
+                throw std::runtime_error("The tiles frontier only supports -d colour and -d natural");
+            }
+            return std::make_unique<TileFrontier>(this->difference_function, this->pixels_wide,
+                                                  this->pixels_high);
+        case FRONTIER_WARM_START:
+            if (metric == COLOUR_METRIC_UNKNOWN) {
+                throw std::runtime_error("The warm frontier needs one of the built-in -d metrics");
+            }
+            return std::make_unique<WarmStartFrontier>(this->difference_function);
     }
-    return neighbours;
+    return nullptr;
 }
 
 /// Fills the list of random colours
@@ -584,51 +815,40 @@ void RainbowRenderer::fillColours() {
                 "Each stripe needs at least enough colours for its seed row(s)");
         }
 
-        // Colours already assigned to some stripe. Prevents a colour matching
-        // two targets (e.g. two identical pink stripes) from being handed to
-        // both — the later stripe just keeps searching further shells.
-        std::set<Colour> claimed;
-        this->stripeSeeds.assign(num_stripes, std::vector<Colour>());
-
-        for (std::size_t i = 0; i < num_stripes; ++i) {
-            const Colour &target = this->startingColours[i];
-            std::vector<Colour> bucket;
-            bucket.reserve(pixels_per_stripe);
-
-            int offset = 0;
-            std::size_t last_size = 0;
-            int dry_passes = 0;
-            while (bucket.size() < pixels_per_stripe && dry_passes < 2) {
-                for (int r = 0; r <= 255 && bucket.size() < pixels_per_stripe; ++r) {
-                    for (int g = 0; g <= 255 && bucket.size() < pixels_per_stripe; ++g) {
-                        for (int b = 0; b <= 255 && bucket.size() < pixels_per_stripe; ++b) {
-                            Colour candidate(r, g, b);
-                            if (claimed.count(candidate)) continue;
-                            const auto hsl = rgbToHsl(r, g, b);
-                            float sat = std::get<1>(hsl);
-                            float lum = std::get<2>(hsl);
-                            if (lum < this->minimumLuminosity || lum > this->maximumLuminosity ||
-                                sat < this->minimumSaturation || sat > this->maximumSaturation) {
-                                continue;
-                            }
-                            int diff = int(this->difference_function(target, candidate));
-                            if (std::abs(diff - offset) <= 1) {
-                                bucket.push_back(candidate);
-                                claimed.insert(candidate);
-                            }
+        // Colours no stripe may take: those outside the saturation and
+        // luminosity bounds, and those already assigned to some stripe.
+        // Prevents a colour matching two targets (e.g. two identical pink
+        // stripes) from being handed to both — the later stripe just takes
+        // colours further out.
+        const HslTable &table = this->hslTable();
+        ColourBitset claimed;
+        this->thread_pool_.parallel_reduce<bool>(
+            ColourBitset::kWords,
+            [&](std::size_t start, std::size_t end) {
+                for (std::size_t word = start; word < end; ++word) {
+                    std::uint64_t bits = 0;
+                    for (std::uint32_t bit = 0; bit < 64; ++bit) {
+                        const std::uint32_t rgb = std::uint32_t(word * 64) + bit;
+                        const float sat = table.sat(rgb);
+                        const float lum = table.lum(rgb);
+                        if (lum < this->minimumLuminosity || lum > this->maximumLuminosity ||
+                            sat < this->minimumSaturation || sat > this->maximumSaturation) {
+                            bits |= std::uint64_t(1) << bit;
                         }
                     }
+                    claimed.setWord(word, bits);
                 }
-                if (bucket.size() == last_size) {
-                    ++dry_passes;
-                } else {
-                    dry_passes = 0;
-                    last_size = bucket.size();
-                }
-                ++offset;
-                std::cout << "Stripe " << i << ": " << bucket.size() << "/"
-                        << pixels_per_stripe << " colours at offset " << offset << std::endl;
-            }
+                return true;
+            },
+            [](bool left, bool right) { return left && right; });
+        std::vector<std::uint16_t> passes(kCubeColours);
+        this->stripeSeeds.assign(num_stripes, std::vector<Colour>());
+
+        for (std::size_t i = 0; i < num_stripes; ++i) {
+            const std::vector<Colour> bucket =
+                    this->claimStripeColours(this->startingColours[i], pixels_per_stripe, claimed, passes);
+            std::cout << "Stripe " << i << ": " << bucket.size() << "/" << pixels_per_stripe << " colours"
+                    << std::endl;
 
             if (bucket.size() < pixels_per_stripe) {
                 std::ostringstream msg;
@@ -642,8 +862,9 @@ void RainbowRenderer::fillColours() {
             // Everything else goes to the shared fill pool.
             this->stripeSeeds[i].assign(bucket.begin(), bucket.begin() + seed_slots);
             std::shuffle(this->stripeSeeds[i].begin(), this->stripeSeeds[i].end(), this->rng);
-            this->colours.insert(this->colours.end(),
-                                 bucket.begin() + seed_slots, bucket.end());
+            for (auto it = bucket.begin() + seed_slots; it != bucket.end(); ++it) {
+                this->colours.push(*it);
+            }
         }
 
         this->applyColourOrdering(true);
@@ -655,80 +876,40 @@ void RainbowRenderer::fillColours() {
             this->colour_depth = ceil(pow(this->pixels_wide * this->pixels_high, 1.0f / 3.0f));
         }
 
-        for (int r = 0; r < this->colour_depth; ++r) {
-            for (int g = 0; g < this->colour_depth; ++g) {
-                for (int b = 0; b < this->colour_depth; ++b) {
-                    this->colours.emplace_back(r * 255 / (this->colour_depth - 1),
-                                               g * 255 / (this->colour_depth - 1),
-                                               b * 255 / (this->colour_depth - 1));
+        // Chunks of rows (one red and green each, every blue) collect
+        // their colours separately, and are joined in order.
+        const int depth = this->colour_depth;
+        this->colours.append(this->thread_pool_.parallel_reduce<PackedColours>(
+            std::size_t(depth) * std::size_t(depth),
+            [depth](std::size_t start, std::size_t end) {
+                PackedColours chunk;
+                chunk.reserve((end - start) * std::size_t(depth));
+                for (std::size_t row = start; row < end; ++row) {
+                    const int r = int(row) / depth;
+                    const int g = int(row) % depth;
+                    for (int b = 0; b < depth; ++b) {
+                        chunk.push_back(std::uint32_t(std::uint8_t(r * 255 / (depth - 1))) << 16 |
+                                        std::uint32_t(std::uint8_t(g * 255 / (depth - 1))) << 8 |
+                                        std::uint32_t(std::uint8_t(b * 255 / (depth - 1))));
+                    }
                 }
-            }
-        }
+                return chunk;
+            },
+            joinColours));
         std::cout << "Colour depth " << this->colour_depth << " makes " << this->colours.size() << " colours (of "
                 << (this->pixels_wide * this->pixels_high) << " pixels)" << std::endl;
     } else {
         std::cout <<
                 "Starting hues/colours detected, ignoring colour depth and instead comparing with provided colours."
                 << std::endl;
-        int offset = 0;
-        std::set<Colour> colourSet;
-        while (colourSet.size() < this->pixels_wide * this->pixels_high) {
-            for (int r = 0; r <= 255; ++r) {
-                for (int g = 0; g <= 255; ++g) {
-                    for (int b = 0; b <= 255; ++b) {
-                        const Colour candidate = Colour(r, g, b);
-                        const auto t = rgbToHsl(r, g, b);
-                        int hue = int(std::get<0>(t) * 360);
-                        float sat = std::get<1>(t);
-                        float lum = std::get<2>(t);
-
-                        for (auto targetHue: this->startingHues) {
-                            // The hue might be close to the target when wrapping around from 360
-                            // so try both and the minimum
-                            int hueDifference = std::abs(hue - targetHue);
-                            if (hueDifference >= 180) {
-                                hueDifference =
-                                        targetHue > hue
-                                            ? std::abs(hue + 360 - targetHue)
-                                            : std::abs(
-                                                hue + targetHue - 360);
-                            }
-                            if (std::abs(hueDifference - offset) <= 1 &&
-                                lum >= this->minimumLuminosity && lum <= this->maximumLuminosity &&
-                                sat >= this->minimumSaturation && sat <= this->maximumSaturation) {
-                                if (colourSet.find(candidate) == colourSet.end()) {
-                                    colourSet.insert(candidate);
-                                    break;
-                                }
-                            }
-                        }
-                        for (const Colour &targetColour: this->startingColours) {
-                            int difference = this->difference_function(targetColour, candidate);
-                            if (std::abs(difference - offset) <= 1) {
-                                if (std::abs(difference - offset) <= 1 &&
-                                    lum >= this->minimumLuminosity && lum <= this->maximumLuminosity &&
-                                    sat >= this->minimumSaturation && sat <= this->maximumSaturation) {
-                                    if (colourSet.find(candidate) == colourSet.end()) {
-                                        colourSet.insert(Colour(r, g, b));
-                                        break;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-            offset += 1;
-            std::cout << "Found " << colourSet.size() << "/" << this->pixels_wide * this->pixels_high <<
-                    " colours with offset of " << offset << std::endl;
-        }
-        this->colours.insert(this->colours.end(), colourSet.begin(), colourSet.end());
+        this->fillNearTargets();
     }
 
-    if (this->colours.size() < this->pixels_wide * this->pixels_high) {
+    const std::size_t total_pixels = std::size_t(this->pixels_wide) * std::size_t(this->pixels_high);
+    if (this->colours.size() < total_pixels) {
         std::ostringstream message;
         message << "All colours were exhausted with only  "
-                << 100 * this->colours.size() / (this->pixels_wide * this->pixels_high)
+                << 100 * this->colours.size() / total_pixels
                 << "% of the image covered. Please revise input parameters" << std::endl;
         throw std::runtime_error(message.str());
     }
@@ -736,6 +917,219 @@ void RainbowRenderer::fillColours() {
     this->applyColourOrdering(false);
 }
 
+void RainbowRenderer::fillNearTargets() {
+    // Each in-bounds colour's distance to its nearest target, by hue for
+    // -H and by difference_function for -C, counting how many sit at each.
+    constexpr std::uint16_t kOutOfBounds = std::numeric_limits<std::uint16_t>::max();
+    const HslTable &table = this->hslTable();
+    std::vector<std::uint16_t> distances(kCubeColours);
+    using Histogram = std::vector<std::size_t>;
+    const Histogram histogram = this->thread_pool_.parallel_reduce<Histogram>(
+        kCubeColours,
+        [&](std::size_t start, std::size_t end) {
+            Histogram counts;
+            for (std::size_t rgb = start; rgb < end; ++rgb) {
+                const Colour candidate = table.colour(std::uint32_t(rgb));
+                if (candidate.lum < this->minimumLuminosity || candidate.lum > this->maximumLuminosity ||
+                    candidate.sat < this->minimumSaturation || candidate.sat > this->maximumSaturation) {
+                    distances[rgb] = kOutOfBounds;
+                    continue;
+                }
+                const int hue = int(candidate.hue * 360);
+                int nearest = std::numeric_limits<int>::max();
+                for (auto targetHue: this->startingHues) {
+                    // The hue might be close to the target when wrapping around from 360
+                    // so try both and the minimum
+                    int hueDifference = std::abs(hue - targetHue);
+                    if (hueDifference >= 180) {
+                        hueDifference =
+                                targetHue > hue
+                                    ? std::abs(hue + 360 - targetHue)
+                                    : std::abs(
+                                        hue + targetHue - 360);
+                    }
+                    nearest = std::min(nearest, hueDifference);
+                }
+                for (const Colour &targetColour: this->startingColours) {
+                    nearest = std::min(nearest, int(this->difference_function(targetColour, candidate)));
+                }
+                distances[rgb] = std::uint16_t(std::min(nearest, kOutOfBounds - 1));
+                if (counts.size() <= distances[rgb]) {
+                    counts.resize(distances[rgb] + 1);
+                }
+                ++counts[distances[rgb]];
+            }
+            return counts;
+        },
+        [](Histogram left, const Histogram &right) {
+            if (left.size() < right.size()) {
+                left.resize(right.size());
+            }
+            for (std::size_t d = 0; d < right.size(); ++d) {
+                left[d] += right[d];
+            }
+            return left;
+        });
+
+    // Widening the allowed distance one step at a time, starting at 1,
+    // stop at the first that admits enough colours. If none does, take
+    // them all and let fillColours report the shortfall.
+    const std::size_t needed = std::size_t(this->pixels_wide) * std::size_t(this->pixels_high);
+    std::size_t limit = histogram.empty() ? 0 : histogram.size() - 1;
+    std::size_t found = 0;
+    for (std::size_t d = 0; d < histogram.size(); ++d) {
+        found += histogram[d];
+        if (d >= 1 && found >= needed) {
+            limit = d;
+            break;
+        }
+    }
+
+    this->colours.append(this->thread_pool_.parallel_reduce<PackedColours>(
+        kCubeColours,
+        [&](std::size_t start, std::size_t end) {
+            PackedColours chunk;
+            for (std::size_t rgb = start; rgb < end; ++rgb) {
+                if (distances[rgb] <= limit) {
+                    chunk.push_back(std::uint32_t(rgb));
+                }
+            }
+            return chunk;
+        },
+        joinColours));
+    std::cout << "Found " << this->colours.size() << "/" << needed << " colours within a distance of " << limit
+            << std::endl;
+}
+
+std::vector<Colour> RainbowRenderer::claimStripeColours(const Colour &target, std::size_t count,
+                                                        ColourBitset &claimed,
+                                                        std::vector<std::uint16_t> &passes) {
+    // A colour at integer distance d from the target would be picked up by
+    // the shell at offset max(0, d - 1): the first shell it is within 1 of.
+    // Work out every unclaimed colour's shell, counting how many each chunk
+    // holds. Chunks are whole words of `claimed`, so the layout below can
+    // set bits in them from different threads.
+    constexpr std::uint16_t kNoPass = std::numeric_limits<std::uint16_t>::max();
+    const HslTable &table = this->hslTable();
+    using Histogram = std::vector<std::size_t>;
+    struct Chunk {
+        std::size_t start;
+        std::size_t end;
+        Histogram counts;
+    };
+    using Chunks = std::vector<Chunk>;
+    const Chunks chunks = this->thread_pool_.parallel_reduce<Chunks>(
+        ColourBitset::kWords,
+        [&](std::size_t start_word, std::size_t end_word) {
+            Chunk chunk{start_word * 64, end_word * 64, Histogram()};
+            for (std::size_t rgb = chunk.start; rgb < chunk.end; ++rgb) {
+                if (claimed.test(std::uint32_t(rgb))) {
+                    passes[rgb] = kNoPass;
+                    continue;
+                }
+                const Colour candidate = table.colour(std::uint32_t(rgb));
+                const int diff = int(this->difference_function(target, candidate));
+                const std::size_t pass = std::size_t(std::max(0, diff - 1));
+                passes[rgb] = std::uint16_t(std::min<std::size_t>(pass, kNoPass - 1));
+                if (chunk.counts.size() <= passes[rgb]) {
+                    chunk.counts.resize(passes[rgb] + 1);
+                }
+                ++chunk.counts[passes[rgb]];
+            }
+            return Chunks{std::move(chunk)};
+        },
+        [](Chunks left, Chunks right) {
+            for (Chunk &chunk: right) {
+                left.push_back(std::move(chunk));
+            }
+            return left;
+        });
+
+    Histogram histogram;
+    for (const Chunk &chunk: chunks) {
+        if (histogram.size() < chunk.counts.size()) {
+            histogram.resize(chunk.counts.size());
+        }
+        for (std::size_t p = 0; p < chunk.counts.size(); ++p) {
+            histogram[p] += chunk.counts[p];
+        }
+    }
+
+    // Take whole shells until the next one would overflow, which is cut
+    // short. Shells emptied by earlier stripes are just passed over, so a
+    // repeated target takes the next colours out. Shell p fills
+    // [offsets[p], ends[p]) of the bucket.
+    std::vector<std::size_t> offsets;
+    std::vector<std::size_t> ends;
+    std::size_t taken = 0;
+    for (std::size_t pass = 0; taken < count && pass < histogram.size(); ++pass) {
+        offsets.push_back(taken);
+        taken += std::min(histogram[pass], count - taken);
+        ends.push_back(taken);
+    }
+
+    // Lay the picks out shell by shell, each shell in cube order. Each
+    // chunk starts its share of a shell where the earlier chunks' shares
+    // end, which places every colour just where one pass over the whole
+    // cube would, and cuts the last shell short at the same colour.
+    std::vector<std::vector<std::size_t>> starts(chunks.size(), offsets);
+    for (std::size_t c = 1; c < chunks.size(); ++c) {
+        const Histogram &before = chunks[c - 1].counts;
+        starts[c] = starts[c - 1];
+        for (std::size_t p = 0; p < offsets.size() && p < before.size(); ++p) {
+            starts[c][p] += before[p];
+        }
+    }
+    std::vector<Colour> bucket(taken);
+    const Histogram written = this->thread_pool_.parallel_shards<Histogram>(
+        chunks.size(), kCubeColours,
+        [&](std::size_t shard) {
+            std::vector<std::size_t> &next = starts[shard];
+            Histogram laid(next.size());
+            for (std::size_t rgb = chunks[shard].start; rgb < chunks[shard].end; ++rgb) {
+                const std::size_t pass = passes[rgb];
+                if (pass >= next.size() || next[pass] >= ends[pass]) {
+                    continue;
+                }
+                bucket[next[pass]++] = table.colour(std::uint32_t(rgb));
+                claimed.set(std::uint32_t(rgb));
+                ++laid[pass];
+            }
+            return laid;
+        },
+        [](Histogram left, const Histogram &right) {
+            for (std::size_t p = 0; p < right.size(); ++p) {
+                left[p] += right[p];
+            }
+            return left;
+        });
+
+    // The chunks' shares of each shell should tile it exactly; anything
+    // else means slots were written twice or left empty.
+    for (std::size_t p = 0; p < offsets.size(); ++p) {
+        if (written[p] != ends[p] - offsets[p]) {
+            throw std::logic_error("Stripe colours were laid out unevenly across chunks");
+        }
+    }
+    return bucket;
+}
+
+const HslTable &RainbowRenderer::hslTable() {
+    if (!this->hsl_table.loaded()) {
+        this->hsl_table.load(this->hsl_table_path, this->thread_pool_);
+        if (this->hsl_table.wasMapped()) {
+            std::cout << "Mapped the HSL table from " << this->hsl_table_path << std::endl;
+        } else {
+            std::cout << "Built the HSL table with " << HslTable::instructionSet() << " kernels";
+            if (!this->hsl_table_path.empty()) {
+                std::cout << " and saved it to " << this->hsl_table_path;
+            }
+            std::cout << std::endl;
+        }
+    }
+    return this->hsl_table;
+}
+
 void RainbowRenderer::applyColourOrdering(bool default_to_random) {
     if (this->colour_ordering.empty()) {
         if (default_to_random) {
@@ -752,7 +1146,7 @@ void RainbowRenderer::applyColourOrdering(bool default_to_random) {
         bool (*compare_func)(const Colour &c1, const Colour &c2);
         switch (order.ordering_type) {
             case COLOUR_ORDER_RANDOM:
-                std::shuffle(std::begin(colours), std::end(colours), rng);
+                this->colours.shuffle(this->rng);
                 continue;
             case COLOUR_ORDER_HUE:
                 compare_func = compareHue;
@@ -767,11 +1161,7 @@ void RainbowRenderer::applyColourOrdering(bool default_to_random) {
                 std::cerr << "Unknown colour ordering " << order.ordering_type << std::endl;
                 return;
         }
-        if (order.reverse) {
-            std::sort(std::rbegin(colours), std::rend(colours), compare_func);
-        } else {
-            std::sort(std::begin(colours), std::end(colours), compare_func);
-        }
+        this->colours.sort(compare_func, order.reverse);
     }
 }
 
@@ -779,25 +1169,39 @@ void RainbowRenderer::applyColourOrdering(bool default_to_random) {
 /// Fills the pixel at the given point
 /// \param point The point to place the pixel at
 void RainbowRenderer::fillPoint(Point &point) {
-    Pixel *pixel = getPixelAtPoint(point);
-    pixel->colour = this->colours[this->colour_index];
-    pixel->is_filled = true;
-    this->pushEdge(point);
+    const Colour colour = this->colours.at(this->colour_index);
+    this->board.fill(point, colour);
+    this->pushEdge(point, colour);
     ++this->colour_index;
 }
 
-void RainbowRenderer::pushEdge(const Point &p) {
-    this->getPixelAtPoint(p)->edge_index = static_cast<int>(this->available_edges.size());
+void RainbowRenderer::pushEdge(const Point &p, const Colour &colour) {
+    this->edge_slots[this->board.indexOf(p)] = std::uint32_t(this->available_edges.size());
+    if (this->frontier_index) {
+        this->frontier_index->insert(this->available_edges.size(), p, colour);
+    }
+    if (this->frontier_buffer) {
+        this->frontier_buffer->push(colour);
+    }
     this->available_edges.push_back(p);
 }
 
 void RainbowRenderer::popEdge(std::size_t idx) {
-    this->getPixelAtPoint(this->available_edges[idx])->edge_index = -1;
+    this->edge_slots[this->board.indexOf(this->available_edges[idx])] = kNotAnEdge;
     const std::size_t last = this->available_edges.size() - 1;
+    if (this->frontier_index) {
+        this->frontier_index->remove(idx);
+        if (idx != last) {
+            this->frontier_index->move(last, idx);
+        }
+    }
+    if (this->frontier_buffer) {
+        this->frontier_buffer->swapPop(idx);
+    }
     if (idx != last) {
         this->available_edges[idx] = this->available_edges[last];
         // The pixel we just moved into `idx` now lives at `idx`, not `last`.
-        this->getPixelAtPoint(this->available_edges[idx])->edge_index = static_cast<int>(idx);
+        this->edge_slots[this->board.indexOf(this->available_edges[idx])] = std::uint32_t(idx);
     }
     this->available_edges.pop_back();
 }
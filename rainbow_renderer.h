@@ -2,11 +2,19 @@
 #define RAINBOW_C_RAINBOW_RENDERER_H
 
 #include <vector>
+#include <memory>
 #include <optional>
+#include <limits>
 #include <random>
 
 #include "colour.h"
-#include "pixel.h"
+#include "colour_bitset.h"
+#include "frontier_buffer.h"
+#include "frontier_index.h"
+#include "hsl_table.h"
+#include "neighbourhood.h"
+#include "palette.h"
+#include "pixel_board.h"
 #include "point.h"
 #include "thread_pool.h"
 
@@ -40,6 +48,24 @@ public:
         FILL_MODE_NEIGHBOUR_AVERAGE,
     };
 
+    /// How edge_fill finds the frontier edge closest to each colour. Every
+    /// type picks the same edge as the linear scan; they only differ in speed.
+    /// FRONTIER_AUTO uses the sorted index for -d lum and -d hue, the k-d
+    /// tree for closest-neighbour fills, and the scan otherwise.
+    ///
+    /// Closest-neighbour fills (-f neighbour) use the same indexes over
+    /// (available point, filled neighbour) pairs.
+    enum FrontierType {
+        FRONTIER_AUTO,
+        FRONTIER_SCAN,
+        FRONTIER_KD_TREE,
+        FRONTIER_GRID,
+        FRONTIER_VP_TREE,
+        FRONTIER_SORTED,
+        FRONTIER_TILES,
+        FRONTIER_WARM_START,
+    };
+
     void setSeed(unsigned int _seed);
 
     void setPixelsWide(int _pixels_wide);
@@ -58,6 +84,18 @@ public:
 
     void setFillMode(FillMode _fill_mode);
 
+    void setFrontierType(FrontierType _frontier_type);
+
+    /// How the board stores its pixels. The layout never changes the output.
+    void setBoardLayout(PixelBoard::Layout layout);
+
+    /// Which pixels count as neighbours, for both placement and scoring.
+    void setConnectivity(Connectivity _connectivity);
+
+    /// Switches edge_fill to approximate search, loosening it for as long as
+    /// at least this fraction of placements still matches the exact pick.
+    void setRecallTarget(float recall);
+
     void addColourOrder(ColourOrdering ordering);
 
     void addStartingHue(int hue);
@@ -76,6 +114,10 @@ public:
 
     void setMaximumSaturation(float saturation);
 
+    /// Keeps the HSL table in the file at `path` between runs, rather than
+    /// building it afresh each time one is needed.
+    void setHslTablePath(const std::string &path);
+
     /// Initialises starting pixels
     void init();
 
@@ -86,8 +128,6 @@ public:
 
     void neighbour_fill(bool neighbour_average = false);
 
-    float getNeighbourDifference(Point point, const Colour &colour, bool neighbour_average = false);
-
     /// Writes the current content of the pixel board out to file
     /// \param _filename
     void writeToFile(const std::string &_filename);
@@ -103,6 +143,11 @@ private:
     std::optional<int> num_start_points;
     StartType start_type = StartType::START_TYPE_CENTRE;
     FillMode fill_mode = FillMode::FILL_MODE_EDGE;
+    FrontierType frontier_type = FrontierType::FRONTIER_AUTO;
+    PixelBoard::Layout board_layout = PixelBoard::LAYOUT_ROWS;
+    Connectivity connectivity = CONNECTIVITY_8;
+    // Unset means edge_fill searches exactly.
+    std::optional<float> recall_target;
     std::vector<ColourOrdering> colour_ordering;
     std::vector<int> startingHues;
     std::vector<Colour> startingColours;
@@ -131,36 +176,80 @@ private:
 
     float (*difference_function)(const Colour &, const Colour &) = getColourAbsoluteDiff;
 
-    std::vector<Colour> colours;
-    std::vector<Pixel> pixels;
+    // Where hsl_table is kept between runs; empty to build it in memory.
+    std::string hsl_table_path;
+    // Only loaded by the passes over the whole colour cube, through
+    // hslTable().
+    HslTable hsl_table;
+
+    Palette colours;
+    PixelBoard board;
     std::vector<Point> available_edges;
+    // Slot in available_edges of each pixel, indexed by board.indexOf(),
+    // or kNotAnEdge for pixels that aren't edges. Sized with the board:
+    // the scan frontier has no index to hold slots, and a hash map keyed
+    // by pixel made every push, pop and cleanup pay for a lookup.
+    static constexpr std::uint32_t kNotAnEdge = std::numeric_limits<std::uint32_t>::max();
+    std::vector<std::uint32_t> edge_slots;
     std::size_t colour_index = 0;
 
+    // Search structure mirroring available_edges, or null when edge_fill
+    // should scan the list directly. Created by init() for edge fills.
+    std::unique_ptr<FrontierIndex> frontier_index;
+
+    // Contiguous copy of the available_edges colours that edge_fill scans
+    // when there's no frontier_index, sharded one per pool thread. Null for
+    // difference functions it can't rank by, which scan through the pixel
+    // board instead.
+    std::unique_ptr<FrontierBuffer> frontier_buffer;
+
     // Launched at construction with hardware_concurrency threads and reused
     // for every parallel min-reduction. Deleted-copy in ThreadPool makes
     // RainbowRenderer non-copyable transitively — that's fine, we never copy it.
     ThreadPool thread_pool_;
 
-    /// Get the pixel at the given x and y coordinates
-    /// \param x The x coordinate
-    /// \param y The y coordinate
-    /// \return The pixel at that position
-    Pixel *getPixel(int x, int y);
+    /// Calls `f` with the Neighbourhood for connectivity, so the fills can
+    /// be specialised on it.
+    template<typename F>
+    void withNeighbourhood(F &&f) const;
+
+    /// edge_fill for neighbourhood `N`.
+    template<typename N>
+    void edgeFillWith();
 
-    /// Gets the pixel at the given point
-    /// \param point The point
-    /// \return The pixel at that point
-    Pixel *getPixelAtPoint(const Point &point);
+    /// neighbour_fill specialised on how it scores a point: `Average` takes
+    /// the mean over the filled neighbours rather than the minimum, `N` is
+    /// the Neighbourhood, and `difference` is a ColourDifference for a
+    /// built-in metric (inlined into the scan) or a ColourDifferenceFunction
+    /// for any other.
+    template<bool Average, typename N, typename Difference>
+    void neighbourFillWith(const Difference &difference);
 
-    /// Gets the neighbour positions of the given point (points over the edge of the board aren ot returned)
-    /// \param point The point to find the neighbours for
-    /// \return The number of neighbours
-    std::vector<Point> getNeighboursOfPoint(const Point &point) const;
+    /// Builds the FrontierIndex for frontier_type, or returns null when the
+    /// fill should scan. Throws if the type can't handle difference_function.
+    std::unique_ptr<FrontierIndex> makeFrontierIndex() const;
+
+    /// hsl_table, loading it the first time it's asked for.
+    const HslTable &hslTable();
 
     /// Fills the list of random colours
     /// \param colour_depth The number of each unique colours in each channel
     void fillColours();
 
+    /// Fills colours for -H and non-stripe -C: every in-bounds colour within
+    /// some distance of its nearest target, the distance being the smallest
+    /// (at least 1) that gives enough colours for the image. In RGB order.
+    void fillNearTargets();
+
+    /// Picks `count` colours for a stripe around `target`, skipping and then
+    /// marking those in `claimed`. Fewer come back if the colours run out.
+    /// `passes` is scratch space of one entry per colour. Gives the colours,
+    /// in the same order, that sweeping the colour cube for ever wider
+    /// shells around the target would: nearest shell first, each shell in
+    /// RGB order.
+    std::vector<Colour> claimStripeColours(const Colour &target, std::size_t count, ColourBitset &claimed,
+                                           std::vector<std::uint16_t> &passes);
+
     /// Apply colour_ordering to this->colours (default to random if empty).
     /// Extracted so fillColours' two branches can share the logic.
     void applyColourOrdering(bool default_to_random);
@@ -169,12 +258,12 @@ private:
     /// \param point The pointto place the pixel at
     void fillPoint(Point &point);
 
-    /// Push a point onto available_edges and record its index on the pixel
-    /// so future removals can happen in O(1).
-    void pushEdge(const Point &p);
+    /// Push a point, just filled with `colour`, onto available_edges and
+    /// record its slot in edge_slots so future removals can happen in O(1).
+    void pushEdge(const Point &p, const Colour &colour);
 
     /// Swap-pop the edge at `idx` from available_edges, keeping the moved
-    /// element's stored edge_index in sync.
+    /// element's entry in edge_slots in sync.
     void popEdge(std::size_t idx);
 };
 
@@ -0,0 +1,48 @@
+#include "recall_controller.h"
+
+#include <algorithm>
+
+RecallController::RecallController(float target_recall)
+    : target_recall_(target_recall),
+      approximation_(target_recall >= 1.0f ? 0.0f : 0.1f) {
+}
+
+void RecallController::recordAudit(bool matched, float approximate_diff, float exact_diff) {
+    ++this->audits_;
+    ++this->window_audits_;
+    if (matched) {
+        ++this->window_matches_;
+    } else {
+        ++this->mismatches_;
+        this->excess_diff_ += approximate_diff - exact_diff;
+    }
+
+    if (this->window_audits_ < kWindowSize) {
+        return;
+    }
+    const float recall = float(this->window_matches_) / float(this->window_audits_);
+    if (recall < this->target_recall_) {
+        this->approximation_ /= 2.0f;
+    } else if (this->target_recall_ < 1.0f) {
+        // Restart from a small factor if an earlier window halved it to
+        // (nearly) nothing, otherwise growth would never get going again.
+        this->approximation_ = std::min(kMaxApproximation,
+                                        std::max(0.01f, this->approximation_ * 1.5f));
+    }
+    this->window_audits_ = 0;
+    this->window_matches_ = 0;
+}
+
+void RecallController::report(std::ostream &os) const {
+    if (this->audits_ == 0) {
+        os << "Approximate search: no placements audited" << std::endl;
+        return;
+    }
+    os << "Approximate search: " << this->mismatches_ << "/" << this->audits_
+            << " audited placements (" << (100.0f * float(this->mismatches_) / float(this->audits_))
+            << "%) differed from the exact search";
+    if (this->mismatches_ > 0) {
+        os << ", by " << (this->excess_diff_ / double(this->mismatches_)) << " on average";
+    }
+    os << ". Final approximation factor " << this->approximation_ << std::endl;
+}
@@ -0,0 +1,51 @@
+#ifndef RAINBOW_C_RECALL_CONTROLLER_H
+#define RAINBOW_C_RECALL_CONTROLLER_H
+
+#include <cstddef>
+#include <iostream>
+
+/// Steers the approximation factor passed to FrontierIndex::nearest() so
+/// that the share of placements picking the same edge as an exact search
+/// tracks a recall target.
+///
+/// Every kAuditInterval placements the caller runs an exact search as well
+/// and reports both results to recordAudit(). After each window of
+/// kWindowSize audits the factor is halved if that window missed the target,
+/// or grown by half again if it met it.
+class RecallController {
+public:
+    /// `target_recall` in (0, 1]: the fraction of placements that should
+    /// match the exact search. 1 still audits, but never loosens the search.
+    explicit RecallController(float target_recall);
+
+    /// The factor to pass to FrontierIndex::nearest() right now.
+    float approximation() const { return approximation_; }
+
+    /// Whether placement number `step` should be audited.
+    bool shouldAudit(std::size_t step) const { return step % kAuditInterval == 0; }
+
+    /// Records one audit: the difference of the edge the approximate search
+    /// picked and of the one the exact search picked.
+    void recordAudit(bool matched, float approximate_diff, float exact_diff);
+
+    /// Prints how often the approximate pick differed, and by how much.
+    void report(std::ostream &os) const;
+
+private:
+    static constexpr std::size_t kAuditInterval = 16;
+    static constexpr std::size_t kWindowSize = 64;
+    static constexpr float kMaxApproximation = 4.0f;
+
+    float target_recall_;
+    float approximation_;
+
+    std::size_t audits_ = 0;
+    std::size_t mismatches_ = 0;
+    // Sum over mismatched audits of (approximate_diff - exact_diff).
+    double excess_diff_ = 0.0;
+
+    std::size_t window_audits_ = 0;
+    std::size_t window_matches_ = 0;
+};
+
+#endif //RAINBOW_C_RECALL_CONTROLLER_H
@@ -0,0 +1,76 @@
+#include "sorted_frontier.h"
+
+#include <limits>
+
+SortedFrontier::SortedFrontier(float (*difference_function)(const Colour &, const Colour &))
+    : difference_function_(difference_function),
+      key_(getColourMetric(difference_function) == COLOUR_METRIC_HUE
+               ? getColourHueKey
+               : getColourLuminosityKey) {
+}
+
+bool SortedFrontier::supports(ColourMetric metric) {
+    return metric == COLOUR_METRIC_HUE || metric == COLOUR_METRIC_LUMINOSITY;
+}
+
+void SortedFrontier::insert(std::size_t slot, const Point &, const Colour &colour) {
+    const float key = this->key_(colour);
+    if (slot >= this->keys_.size()) {
+        this->keys_.resize(slot + 1);
+    }
+    this->keys_[slot] = key;
+    auto it = this->buckets_.try_emplace(key, Bucket{colour, {}}).first;
+    it->second.slots.insert(static_cast<std::uint32_t>(slot));
+}
+
+void SortedFrontier::remove(std::size_t slot) {
+    auto it = this->buckets_.find(this->keys_[slot]);
+    it->second.slots.erase(static_cast<std::uint32_t>(slot));
+    if (it->second.slots.empty()) {
+        this->buckets_.erase(it);
+    }
+}
+
+void SortedFrontier::move(std::size_t from, std::size_t to) {
+    const float key = this->keys_[from];
+    std::set<std::uint32_t> &slots = this->buckets_.find(key)->second.slots;
+    slots.erase(static_cast<std::uint32_t>(from));
+    slots.insert(static_cast<std::uint32_t>(to));
+    if (to >= this->keys_.size()) {
+        this->keys_.resize(to + 1);
+    }
+    this->keys_[to] = key;
+}
+
+std::size_t SortedFrontier::nearest(const Colour &colour, float) {
+    float best_diff = std::numeric_limits<float>::max();
+    std::size_t best_slot = std::numeric_limits<std::size_t>::max();
+
+    // Moving away from the query key in either direction, the difference
+    // never decreases (float subtraction is monotonic), so each walk can
+    // stop at the first bucket that's strictly worse than the best. Walking
+    // through equal differences picks up ties from neighbouring keys.
+    const auto visit = [&](const Bucket &bucket) {
+        const float diff = this->difference_function_(colour, bucket.colour);
+        if (diff > best_diff) {
+            return false;
+        }
+        const std::size_t slot = *bucket.slots.begin();
+        if (diff < best_diff || slot < best_slot) {
+            best_diff = diff;
+            best_slot = slot;
+        }
+        return true;
+    };
+
+    const auto split = this->buckets_.lower_bound(this->key_(colour));
+    for (auto it = split; it != this->buckets_.end() && visit(it->second); ++it) {
+    }
+    for (auto it = split; it != this->buckets_.begin();) {
+        --it;
+        if (!visit(it->second)) {
+            break;
+        }
+    }
+    return best_slot;
+}
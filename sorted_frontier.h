@@ -0,0 +1,50 @@
+#ifndef RAINBOW_C_SORTED_FRONTIER_H
+#define RAINBOW_C_SORTED_FRONTIER_H
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "frontier_index.h"
+
+/// The frontier sorted by a single scalar key, for the one-dimensional
+/// metrics: -d lum compares luminosity and -d hue compares (hue - lum).
+///
+/// The closest edge is then the key's predecessor or successor, so every
+/// operation is O(log n). Edges sharing a key share a bucket that keeps its
+/// slots ordered, so the lowest-slot tie is always at hand.
+///
+/// Always exact; nearest() ignores `approximation`.
+class SortedFrontier : public FrontierIndex {
+public:
+    explicit SortedFrontier(float (*difference_function)(const Colour &, const Colour &));
+
+    /// Whether `metric` reduces to a scalar key this index can sort by.
+    static bool supports(ColourMetric metric);
+
+    void insert(std::size_t slot, const Point &point, const Colour &colour) override;
+
+    void remove(std::size_t slot) override;
+
+    void move(std::size_t from, std::size_t to) override;
+
+    std::size_t nearest(const Colour &colour, float approximation) override;
+
+private:
+    struct Bucket {
+        // Any one colour with this key; all of them are equally far from
+        // every query, so one stands in for the lot.
+        Colour colour;
+        std::set<std::uint32_t> slots;
+    };
+
+    float (*difference_function_)(const Colour &, const Colour &);
+    float (*key_)(const Colour &);
+
+    std::map<float, Bucket> buckets_;
+    // Key of the edge at each slot, to find its bucket again.
+    std::vector<float> keys_;
+};
+
+#endif //RAINBOW_C_SORTED_FRONTIER_H
@@ -9,21 +9,26 @@
 ThreadPool::ThreadPool(std::size_t num_threads) {
     // hardware_concurrency() may return 0 on systems that can't determine
     // the count (rare, but the standard permits it). We need at least one
-    // worker or parallel_range() would deadlock.
+    // worker or parallel_reduce() would never split a range.
     if (num_threads == 0) num_threads = 1;
 
     // reserve() pre-sizes the vector's storage so subsequent push_backs
     // don't reallocate. Optional, but tidy.
     workers_.reserve(num_threads);
 
+    // Every worker's pinned slot must exist before any worker can look
+    // at it.
+    pinned_.resize(num_threads);
+
     for (std::size_t i = 0; i < num_threads; ++i) {
         // emplace_back constructs a std::thread in place. The lambda is the
         // thread's start function — it runs on the new thread as soon as
         // the constructor returns.
         //
-        // `[this]` captures the ThreadPool pointer by value so the lambda
-        // can call the private worker_loop() method.
-        workers_.emplace_back([this] { worker_loop(); });
+        // `[this, i]` captures the ThreadPool pointer and the worker's
+        // number by value so the lambda can call the private worker_loop()
+        // method.
+        workers_.emplace_back([this, i] { worker_loop(i); });
     }
 }
 
@@ -56,7 +61,7 @@ ThreadPool::~ThreadPool() {
 
 // ─── worker_loop ──────────────────────────────────────────────────────────
 // The body that every worker thread runs. Sleep, wake, do work, repeat.
-void ThreadPool::worker_loop() {
+void ThreadPool::worker_loop(std::size_t index) {
     while (true) {
         Task task;
 
@@ -71,28 +76,36 @@ void ThreadPool::worker_loop() {
             // it goes back to sleep. This handles "spurious wakeups" — the
             // OS may wake threads without a matching notify, and the
             // predicate keeps us correct in that case.
-            task_available_.wait(lock, [this] {
-                return !task_queue_.empty() || shutdown_;
+            PinnedTask &pinned = pinned_[index];
+            task_available_.wait(lock, [this, &pinned] {
+                return pinned.queued || !task_queue_.empty() || shutdown_;
             });
 
             // If we're shutting down AND there's no more work to do, exit
             // the thread. We drain the queue even during shutdown so no
             // dispatched batch is silently dropped.
-            if (shutdown_ && task_queue_.empty()) {
+            if (shutdown_ && !pinned.queued && task_queue_.empty()) {
                 return;
             }
 
-            // Pop one task off the front of the queue. std::move avoids
-            // copying the std::function; it transfers ownership to `task`.
-            task = std::move(task_queue_.front());
-            task_queue_.pop();
+            // Take our own pinned task if there is one, otherwise pop one
+            // off the front of the queue. It's a few plain words — the
+            // callable stays with the caller, who is blocked in run_chunks()
+            // or run_pinned() until we're done with it.
+            if (pinned.queued) {
+                task = pinned.task;
+                pinned.queued = false;
+            } else {
+                task = task_queue_.front();
+                task_queue_.pop();
+            }
             // The lock releases here as `lock` goes out of scope at the `}`.
         }
 
         // Run the user's callback for our chunk. Crucially, we're NOT
         // holding the mutex — other workers can pop and run their own
         // chunks concurrently.
-        task.func(task.worker_id, task.start, task.end);
+        task.func(task.context, task.chunk, task.start, task.end);
 
         {
             // Reacquire the mutex to update pending_ safely.
@@ -100,8 +113,8 @@ void ThreadPool::worker_loop() {
             --pending_;
 
             // If we just finished the last chunk of the batch, wake the
-            // main thread that's blocked in parallel_range() waiting for
-            // pending_ to hit zero.
+            // main thread that's blocked in run_chunks() or run_pinned()
+            // waiting for pending_ to hit zero.
             if (pending_ == 0) {
                 task_completed_.notify_one();
             }
@@ -109,40 +122,20 @@ void ThreadPool::worker_loop() {
     }
 }
 
-// ─── parallel_range ───────────────────────────────────────────────────────
-// The public work-dispatch entry point. Splits [0, count) into up to
-// num_workers() chunks and blocks until every one finishes.
-void ThreadPool::parallel_range(std::size_t count, RangeFunc func) {
-    // Empty ranges are a no-op. Without this check the ceiling division
-    // below would still work, but skipping the mutex is cheaper.
-    if (count == 0) return;
-
-    const std::size_t n = workers_.size();
-
-    // Ceiling division: how many items each chunk gets. The last chunk may
-    // be shorter (see the std::min below). Example: count=100, n=8 →
-    // chunk_size=13, chunks are [0,13), [13,26), … , [91,100).
-    const std::size_t chunk_size = (count + n - 1) / n;
-
+// ─── run_chunks ───────────────────────────────────────────────────────────
+// The dispatch behind parallel_reduce(). Hands chunks 1 and up to the
+// workers, runs chunk 0 here, and blocks until every one finishes.
+void ThreadPool::run_chunks(std::size_t chunks, std::size_t chunk_size, std::size_t count,
+                            ChunkFunc func, const void *context) {
     {
-        // Push one task per worker under the lock so workers see a
+        // Push one task per worker chunk under the lock so workers see a
         // consistent queue when they wake.
         std::unique_lock<std::mutex> lock(mutex_);
 
-        for (std::size_t w = 0; w < n; ++w) {
-            std::size_t start = w * chunk_size;
-
-            // If count < n, later workers get no chunk. Their per-worker
-            // output slots must be pre-initialised by the caller (see the
-            // header docs).
-            if (start >= count) break;
-
-            std::size_t end = std::min(start + chunk_size, count);
-
-            // Copies `func` into the queued Task. std::function copy is
-            // cheap in practice — it's an internal pointer bump for
-            // heap-allocated callables, and inline storage for small ones.
-            task_queue_.push({func, w, start, end});
+        for (std::size_t c = 1; c < chunks; ++c) {
+            const std::size_t start = c * chunk_size;
+            const std::size_t end = std::min(start + chunk_size, count);
+            task_queue_.push({func, context, c, start, end});
             ++pending_;
         }
     }
@@ -151,6 +144,9 @@ void ThreadPool::parallel_range(std::size_t count, RangeFunc func) {
     // fewer chunks than workers) and go back to sleep — that's harmless.
     task_available_.notify_all();
 
+    // Rather than idle while the workers run, do the first chunk ourselves.
+    func(context, 0, 0, std::min(chunk_size, count));
+
     {
         // Block until pending_ reaches zero. The predicate handles the
         // case where the batch finishes before we even get here — wait()
@@ -160,3 +156,29 @@ void ThreadPool::parallel_range(std::size_t count, RangeFunc func) {
         task_completed_.wait(lock, [this] { return pending_ == 0; });
     }
 }
+
+// ─── run_pinned ───────────────────────────────────────────────────────────
+// The dispatch behind parallel_shards(). Like run_chunks(), but each shard
+// goes to the one worker that always runs it.
+void ThreadPool::run_pinned(std::size_t shards, ChunkFunc func, const void *context) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        for (std::size_t s = 1; s < shards; ++s) {
+            pinned_[s - 1].task = {func, context, s, 0, 0};
+            pinned_[s - 1].queued = true;
+            ++pending_;
+        }
+    }
+
+    // notify_all, not notify_one: each task is meant for a particular
+    // worker, and only waking everyone is sure to wake that one.
+    task_available_.notify_all();
+
+    func(context, 0, 0, 0);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        task_completed_.wait(lock, [this] { return pending_ == 0; });
+    }
+}
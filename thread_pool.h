@@ -1,9 +1,9 @@
 #ifndef RAINBOW_C_THREAD_POOL_H
 #define RAINBOW_C_THREAD_POOL_H
 
+#include <algorithm>
 #include <condition_variable>
 #include <cstddef>
-#include <functional>
 #include <mutex>
 #include <queue>
 #include <thread>
@@ -12,21 +12,14 @@
 /// A fixed-size pool of worker threads for parallel min-reductions.
 ///
 /// Workers are started once by the constructor and reused for every call to
-/// parallel_range(), so the cost of launching threads is paid once — not per
+/// parallel_reduce(), so the cost of launching threads is paid once — not per
 /// scan.
 ///
 /// Not thread-safe against concurrent calls: only one thread may invoke
-/// parallel_range() at a time. That's fine for our use — RainbowRenderer's
+/// parallel_reduce() at a time. That's fine for our use — RainbowRenderer's
 /// fill loop is single-producer.
 class ThreadPool {
 public:
-    /// Signature of the callback passed to parallel_range().
-    /// Arguments: (worker_id, start_index, end_index_exclusive).
-    /// The callback runs on a worker thread, over the half-open range
-    /// [start_index, end_index_exclusive). `worker_id` is stable across a
-    /// single parallel_range() call and unique per running chunk.
-    using RangeFunc = std::function<void(std::size_t, std::size_t, std::size_t)>;
-
     /// Launches `num_threads` workers. Defaults to hardware_concurrency(),
     /// which reports the number of hardware threads the CPU exposes. Some
     /// systems return 0 from that call, so we clamp to a minimum of 1.
@@ -43,29 +36,132 @@ public:
     ThreadPool(const ThreadPool&) = delete;
     ThreadPool& operator=(const ThreadPool&) = delete;
 
-    /// Splits the index range [0, count) into up to num_workers() chunks and
-    /// dispatches each to a worker. Blocks the caller until every chunk has
-    /// finished executing.
+    /// Splits the index range [0, count) into up to num_workers() contiguous
+    /// chunks, computes `map(start, end_exclusive)` for each, and folds the
+    /// chunk results together in chunk order with `combine(left, right)`.
+    /// Blocks until done and returns the folded value. `count` must be
+    /// non-zero, and T default-constructible.
+    ///
+    /// The calling thread runs the first chunk itself rather than sleeping
+    /// while the workers run theirs. Ranges too short to be worth waking a
+    /// worker for (under kMinChunk items per chunk) run entirely on the
+    /// caller.
+    ///
+    /// `map` and `combine` are called directly, not through std::function:
+    /// workers get a plain function pointer plus a pointer to them, which
+    /// is safe because this doesn't return until every chunk has finished.
+    template<typename T, typename Map, typename Combine>
+    T parallel_reduce(std::size_t count, const Map &map, const Combine &combine) {
+        std::size_t chunks = std::min(workers_.size(), (count + kMinChunk - 1) / kMinChunk);
+        if (chunks <= 1) {
+            return map(std::size_t(0), count);
+        }
+        // Ceiling division, then recount: e.g. 5 items over 4 chunks gives
+        // chunks of 2, so only 3 chunks are non-empty.
+        const std::size_t chunk_size = (count + chunks - 1) / chunks;
+        chunks = (count + chunk_size - 1) / chunk_size;
+
+        // One result per chunk, each on its own cache line so workers
+        // writing neighbouring results don't keep stealing it from each
+        // other.
+        std::vector<Padded<T>> results(chunks);
+        struct Context {
+            const Map *map;
+            Padded<T> *results;
+        } context{&map, results.data()};
+        run_chunks(chunks, chunk_size, count,
+                   [](const void *opaque, std::size_t chunk, std::size_t start, std::size_t end) {
+                       const Context *ctx = static_cast<const Context *>(opaque);
+                       ctx->results[chunk].value = (*ctx->map)(start, end);
+                   },
+                   &context);
+
+        T result = std::move(results[0].value);
+        for (std::size_t c = 1; c < chunks; ++c) {
+            result = combine(std::move(result), std::move(results[c].value));
+        }
+        return result;
+    }
+
+    /// Computes `map(shard)` for every shard in [0, shards), and folds the
+    /// results together in shard order with `combine(left, right)`. Blocks
+    /// until done and returns the folded value. `shards` must be between 1
+    /// and num_workers().
     ///
-    /// If `count < num_workers()`, some workers receive no chunk. Any
-    /// per-worker output slot indexed by their worker_id will NOT be written
-    /// in that case — callers should initialise output slots to a sentinel
-    /// (e.g. std::numeric_limits<float>::max() for a min-reduction) so the
-    /// final reduce step still produces a correct answer.
-    void parallel_range(std::size_t count, RangeFunc func);
+    /// Unlike parallel_reduce(), each shard always runs on the same thread:
+    /// shard 0 on the caller and shard s on worker s - 1. Data a shard owns
+    /// then stays in one core's cache from call to call. With fewer than
+    /// kMinChunk items of `work` per shard, every shard runs on the caller.
+    template<typename T, typename Map, typename Combine>
+    T parallel_shards(std::size_t shards, std::size_t work, const Map &map, const Combine &combine) {
+        if (shards <= 1 || work < shards * kMinChunk) {
+            T result = map(std::size_t(0));
+            for (std::size_t s = 1; s < shards; ++s) {
+                result = combine(std::move(result), map(s));
+            }
+            return result;
+        }
+
+        std::vector<Padded<T>> results(shards);
+        struct Context {
+            const Map *map;
+            Padded<T> *results;
+        } context{&map, results.data()};
+        run_pinned(shards,
+                   [](const void *opaque, std::size_t shard, std::size_t, std::size_t) {
+                       const Context *ctx = static_cast<const Context *>(opaque);
+                       ctx->results[shard].value = (*ctx->map)(shard);
+                   },
+                   &context);
+
+        T result = std::move(results[0].value);
+        for (std::size_t s = 1; s < shards; ++s) {
+            result = combine(std::move(result), std::move(results[s].value));
+        }
+        return result;
+    }
 
     /// Number of worker threads in the pool. Fixed for the pool's lifetime.
     std::size_t num_workers() const { return workers_.size(); }
 
 private:
+    /// Fewest items per chunk parallel_reduce() will hand to a worker.
+    static constexpr std::size_t kMinChunk = 1024;
+
+    /// What a worker runs for one chunk: the chunk's number and its
+    /// half-open range, plus the context pointer it was queued with.
+    using ChunkFunc = void (*)(const void *, std::size_t, std::size_t, std::size_t);
+
+    /// Pads a chunk result out to a whole cache line.
+    template<typename T>
+    struct alignas(64) Padded {
+        T value;
+    };
+
     /// One unit of work handed to a worker.
     struct Task {
-        RangeFunc func;
-        std::size_t worker_id;
+        ChunkFunc func;
+        const void *context;
+        std::size_t chunk;
         std::size_t start;
         std::size_t end;
     };
 
+    /// A task addressed to one particular worker.
+    struct PinnedTask {
+        Task task;
+        bool queued = false;
+    };
+
+    /// Queues chunks 1 .. chunks - 1 of [0, count) for the workers, runs
+    /// chunk 0 on the calling thread, then blocks until all have finished.
+    void run_chunks(std::size_t chunks, std::size_t chunk_size, std::size_t count,
+                    ChunkFunc func, const void *context);
+
+    /// Hands shard s, for s in 1 .. shards - 1, to worker s - 1, runs shard
+    /// 0 on the calling thread, then blocks until all have finished.
+    void run_pinned(std::size_t shards, ChunkFunc func, const void *context);
+
     // The worker threads. Owning `std::thread`s here means the pool controls
     // their lifetime — they're started in the constructor and joined in the
     // destructor.
@@ -74,8 +170,13 @@ private:
     // Pending chunks waiting to be picked up. Guarded by `mutex_`.
     std::queue<Task> task_queue_;
 
-    // The single mutex guarding all shared state: task_queue_, pending_,
-    // shutdown_. Held only briefly — never across the user's callback.
+    // One slot per worker for a task only that worker may run, which it
+    // takes ahead of task_queue_. Sized before the workers start. Guarded
+    // by `mutex_`.
+    std::vector<PinnedTask> pinned_;
+
+    // The single mutex guarding all shared state: task_queue_, pinned_,
+    // pending_, shutdown_. Held only briefly — never across the user's callback.
     std::mutex mutex_;
 
     // Workers sleep on this when the queue is empty. Signalled by the main
@@ -94,9 +195,9 @@ private:
     // Destructor sets this to true and wakes all workers so they exit.
     bool shutdown_ = false;
 
-    /// The body of each worker thread. Loops until shutdown_ is set and the
+    /// The body of worker `index`. Loops until shutdown_ is set and the
     /// queue drains.
-    void worker_loop();
+    void worker_loop(std::size_t index);
 };
 
 #endif // RAINBOW_C_THREAD_POOL_H
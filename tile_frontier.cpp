@@ -0,0 +1,103 @@
+#include "tile_frontier.h"
+
+#include <algorithm>
+#include <limits>
+
+TileFrontier::TileFrontier(float (*difference_function)(const Colour &, const Colour &), int pixels_wide,
+                           int pixels_high)
+    : difference_function_(difference_function),
+      metric_(getColourMetric(difference_function)),
+      tiles_wide_((pixels_wide + kTileSize - 1) / kTileSize),
+      tiles_(static_cast<std::size_t>(this->tiles_wide_) * ((pixels_high + kTileSize - 1) / kTileSize)) {
+}
+
+void TileFrontier::insert(std::size_t slot, const Point &point, const Colour &colour) {
+    const int tile_index = (point.y / kTileSize) * this->tiles_wide_ + point.x / kTileSize;
+    Tile &tile = this->tiles_[tile_index];
+    // A stale box still covers everything in the tile, so growing it keeps
+    // it valid; it just stays loose until the next refresh.
+    tile.bounds.expand(colour);
+    if (slot >= this->locations_.size()) {
+        this->locations_.resize(slot + 1);
+    }
+    this->locations_[slot] = {tile_index, static_cast<int>(tile.entries.size())};
+    if (tile.entries.empty()) {
+        tile.occupied_position = static_cast<int>(this->occupied_.size());
+        this->occupied_.push_back(tile_index);
+    }
+    tile.entries.push_back({colour, static_cast<std::uint32_t>(slot)});
+}
+
+void TileFrontier::remove(std::size_t slot) {
+    const Location location = this->locations_[slot];
+    Tile &tile = this->tiles_[location.tile];
+    if (location.position != static_cast<int>(tile.entries.size()) - 1) {
+        tile.entries[location.position] = tile.entries.back();
+        this->locations_[tile.entries[location.position].slot].position = location.position;
+    }
+    tile.entries.pop_back();
+    tile.stale = true;
+    this->locations_[slot] = Location();
+    if (tile.entries.empty()) {
+        const int moved = this->occupied_.back();
+        this->occupied_[tile.occupied_position] = moved;
+        this->tiles_[moved].occupied_position = tile.occupied_position;
+        this->occupied_.pop_back();
+        tile.occupied_position = -1;
+    }
+}
+
+void TileFrontier::move(std::size_t from, std::size_t to) {
+    const Location location = this->locations_[from];
+    this->tiles_[location.tile].entries[location.position].slot = static_cast<std::uint32_t>(to);
+    this->locations_[to] = location;
+    this->locations_[from] = Location();
+}
+
+std::size_t TileFrontier::nearest(const Colour &colour, float approximation) {
+    const float scale = 1.0f + approximation;
+    float best_diff = std::numeric_limits<float>::max();
+    std::size_t best_slot = std::numeric_limits<std::size_t>::max();
+
+    // Min-heap of (lower bound, tile) over the tiles with edges in them.
+    // Building it is linear, and only the tiles actually visited are
+    // popped, so a query costs far less than sorting every tile.
+    const auto later = [](const std::pair<float, int> &a, const std::pair<float, int> &b) { return a > b; };
+    this->order_.clear();
+    for (const int t: this->occupied_) {
+        this->order_.emplace_back(this->tiles_[t].bounds.lowerBound(this->metric_, colour), t);
+    }
+    std::make_heap(this->order_.begin(), this->order_.end(), later);
+
+    while (!this->order_.empty()) {
+        std::pop_heap(this->order_.begin(), this->order_.end(), later);
+        const auto [bound, t] = this->order_.back();
+        this->order_.pop_back();
+        // Strictly greater: an equal bound could still hide a lower-slot tie.
+        if (bound * scale > best_diff) {
+            break;
+        }
+        Tile &tile = this->tiles_[t];
+        if (tile.stale) {
+            // A stale box is loose but still a valid bound, so it's only
+            // tightened once a query reaches the tile, which then goes back
+            // in the heap under its true bound.
+            tile.bounds = ColourBounds();
+            for (const Entry &entry: tile.entries) {
+                tile.bounds.expand(entry.colour);
+            }
+            tile.stale = false;
+            this->order_.emplace_back(tile.bounds.lowerBound(this->metric_, colour), t);
+            std::push_heap(this->order_.begin(), this->order_.end(), later);
+            continue;
+        }
+        for (const Entry &entry: tile.entries) {
+            const float diff = this->difference_function_(colour, entry.colour);
+            if (diff < best_diff || (diff == best_diff && entry.slot < best_slot)) {
+                best_diff = diff;
+                best_slot = entry.slot;
+            }
+        }
+    }
+    return best_slot;
+}
@@ -0,0 +1,71 @@
+#ifndef RAINBOW_C_TILE_FRONTIER_H
+#define RAINBOW_C_TILE_FRONTIER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "colour_bounds.h"
+#include "frontier_index.h"
+
+/// The frontier split by board position into kTileSize x kTileSize tiles,
+/// each keeping the RGB bounding box of the edges inside it.
+///
+/// nearest() visits tiles in order of their box's lower bound, popping them
+/// off a heap, and stops at the first one that can't beat the best edge
+/// found, so whole regions of the frontier are skipped. Only tiles holding
+/// edges are considered at all. Within a tile edges are scanned in the order
+/// they were added, which keeps the spatial locality a colour-space index
+/// gives up.
+///
+/// Boxes grow on insert. A removal only marks its tile stale, and a stale
+/// box is recomputed when a query reaches its tile — typically a handful of
+/// tiles per placement.
+class TileFrontier : public FrontierIndex {
+public:
+    TileFrontier(float (*difference_function)(const Colour &, const Colour &), int pixels_wide,
+                 int pixels_high);
+
+    void insert(std::size_t slot, const Point &point, const Colour &colour) override;
+
+    void remove(std::size_t slot) override;
+
+    void move(std::size_t from, std::size_t to) override;
+
+    std::size_t nearest(const Colour &colour, float approximation) override;
+
+private:
+    static constexpr int kTileSize = 64;
+
+    struct Entry {
+        Colour colour;
+        std::uint32_t slot;
+    };
+
+    struct Tile {
+        ColourBounds bounds;
+        bool stale = false;
+        std::vector<Entry> entries;
+        // Position in occupied_, or -1 while the tile is empty.
+        int occupied_position = -1;
+    };
+
+    struct Location {
+        int tile = -1;
+        int position = -1;
+    };
+
+    float (*difference_function_)(const Colour &, const Colour &);
+    ColourMetric metric_;
+    int tiles_wide_;
+
+    std::vector<Tile> tiles_;
+    std::vector<Location> locations_;
+
+    // The tiles holding at least one edge, in no particular order.
+    std::vector<int> occupied_;
+
+    // Scratch for nearest(): a heap of (lower bound, tile).
+    std::vector<std::pair<float, int>> order_;
+};
+
+#endif //RAINBOW_C_TILE_FRONTIER_H
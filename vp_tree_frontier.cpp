@@ -0,0 +1,206 @@
+#include "vp_tree_frontier.h"
+
+#include <algorithm>
+
+VpTreeFrontier::VpTreeFrontier(float (*difference_function)(const Colour &, const Colour &))
+    : difference_function_(difference_function),
+      triangle_(TriangleBound::forMetric(difference_function)) {
+    this->nodes_.emplace_back();
+}
+
+void VpTreeFrontier::insert(std::size_t slot, const Point &, const Colour &colour) {
+    int node = 0;
+    while (!this->nodes_[node].leaf) {
+        Node &n = this->nodes_[node];
+        ++n.count;
+        const float d = this->triangle_.distance(n.vantage, colour);
+        Child &child = n.children[d < n.radius ? 0 : 1];
+        child.lo = std::min(child.lo, d);
+        child.hi = std::max(child.hi, d);
+        node = child.node;
+    }
+
+    Node &leaf = this->nodes_[node];
+    ++leaf.count;
+    if (slot >= this->locations_.size()) {
+        this->locations_.resize(slot + 1);
+    }
+    this->locations_[slot] = {node, static_cast<int>(leaf.entries.size())};
+    leaf.entries.push_back({colour, static_cast<std::uint32_t>(slot)});
+    ++this->size_;
+    ++this->churn_;
+
+    if (leaf.entries.size() > leaf.split_at) {
+        std::vector<Entry> entries = std::move(leaf.entries);
+        this->build(node, entries);
+    }
+}
+
+void VpTreeFrontier::remove(std::size_t slot) {
+    const Location location = this->locations_[slot];
+    std::vector<Entry> &entries = this->nodes_[location.node].entries;
+    if (location.position != static_cast<int>(entries.size()) - 1) {
+        entries[location.position] = entries.back();
+        this->locations_[entries[location.position].slot].position = location.position;
+    }
+    entries.pop_back();
+    this->locations_[slot] = Location();
+    for (int node = location.node; node >= 0; node = this->nodes_[node].parent) {
+        --this->nodes_[node].count;
+    }
+    --this->size_;
+    ++this->churn_;
+
+    if (this->churn_ > 2 * this->size_ + 1024) {
+        this->rebuild();
+    }
+}
+
+void VpTreeFrontier::move(std::size_t from, std::size_t to) {
+    const Location location = this->locations_[from];
+    this->nodes_[location.node].entries[location.position].slot = static_cast<std::uint32_t>(to);
+    this->locations_[to] = location;
+    this->locations_[from] = Location();
+}
+
+std::size_t VpTreeFrontier::nearest(const Colour &colour, float approximation) {
+    const float scale = 1.0f + approximation;
+    float best_diff = std::numeric_limits<float>::max();
+    std::size_t best_slot = std::numeric_limits<std::size_t>::max();
+
+    this->stack_.clear();
+    this->stack_.push_back({0, -std::numeric_limits<float>::max()});
+    while (!this->stack_.empty()) {
+        const Pending pending = this->stack_.back();
+        this->stack_.pop_back();
+        const Node &node = this->nodes_[pending.node];
+        // Strictly greater: an equal bound could still hide a lower-slot tie.
+        if (node.count == 0 || pending.bound * scale > best_diff) {
+            continue;
+        }
+
+        if (node.leaf) {
+            for (const Entry &entry: node.entries) {
+                const float diff = this->difference_function_(colour, entry.colour);
+                if (diff < best_diff || (diff == best_diff && entry.slot < best_slot)) {
+                    best_diff = diff;
+                    best_slot = entry.slot;
+                }
+            }
+            continue;
+        }
+
+        // Triangle inequality: anything whose distance to the vantage is in
+        // [lo, hi] is at least max(lo - dq, dq - hi) from the query.
+        const float dq = this->triangle_.distance(colour, node.vantage);
+        Pending children[2];
+        for (int side = 0; side < 2; ++side) {
+            const Child &child = node.children[side];
+            const float lower = std::max(0.0f, std::max(child.lo - dq, dq - child.hi));
+            children[side] = {child.node, this->triangle_.bound(lower)};
+        }
+        const int near = dq < node.radius ? 0 : 1;
+        this->stack_.push_back(children[1 - near]);
+        this->stack_.push_back(children[near]);
+    }
+    return best_slot;
+}
+
+void VpTreeFrontier::build(int node, std::vector<Entry> &entries) {
+    const auto makeLeaf = [&](std::size_t split_at) {
+        Node &leaf = this->nodes_[node];
+        leaf.leaf = true;
+        leaf.split_at = split_at;
+        leaf.count = entries.size();
+        leaf.entries = std::move(entries);
+        for (std::size_t i = 0; i < leaf.entries.size(); ++i) {
+            this->locations_[leaf.entries[i].slot] = {node, static_cast<int>(i)};
+        }
+    };
+    if (entries.size() <= kLeafSize) {
+        makeLeaf(kLeafSize);
+        return;
+    }
+
+    // The entry farthest from an arbitrary one sits near the edge of the
+    // set, which makes for a better spread of distances than a central one.
+    Colour vantage = entries[0].colour;
+    float farthest = -1.0f;
+    for (const Entry &entry: entries) {
+        const float d = this->triangle_.distance(entries[0].colour, entry.colour);
+        if (d > farthest) {
+            farthest = d;
+            vantage = entry.colour;
+        }
+    }
+
+    std::vector<float> distances(entries.size());
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        distances[i] = this->triangle_.distance(vantage, entries[i].colour);
+    }
+    std::vector<float> sorted = distances;
+    const auto mid = sorted.begin() + sorted.size() / 2;
+    std::nth_element(sorted.begin(), mid, sorted.end());
+    float radius = *mid;
+    const float min_distance = *std::min_element(sorted.begin(), sorted.end());
+    if (radius == min_distance) {
+        // Too many entries tie at the minimum: put all of them on the near
+        // side, and the next distance up starts the far side.
+        float next = std::numeric_limits<float>::max();
+        for (float d: sorted) {
+            if (d > min_distance) next = std::min(next, d);
+        }
+        if (next == std::numeric_limits<float>::max()) {
+            // Every entry is the same distance away; there's no split.
+            // Don't try again until the leaf has doubled, or every insert
+            // into it would come back here.
+            makeLeaf(2 * entries.size());
+            return;
+        }
+        radius = next;
+    }
+
+    std::vector<Entry> halves[2];
+    Child ranges[2];
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const int side = distances[i] < radius ? 0 : 1;
+        halves[side].push_back(entries[i]);
+        ranges[side].lo = std::min(ranges[side].lo, distances[i]);
+        ranges[side].hi = std::max(ranges[side].hi, distances[i]);
+    }
+    const std::size_t count = entries.size();
+    entries.clear();
+    entries.shrink_to_fit();
+
+    // Create both children before recursing: emplace_back may reallocate
+    // nodes_, so no Node references are held across it.
+    for (int side = 0; side < 2; ++side) {
+        ranges[side].node = static_cast<int>(this->nodes_.size());
+        this->nodes_.emplace_back();
+        this->nodes_.back().parent = node;
+    }
+    Node &n = this->nodes_[node];
+    n.leaf = false;
+    n.vantage = vantage;
+    n.radius = radius;
+    n.count = count;
+    n.children[0] = ranges[0];
+    n.children[1] = ranges[1];
+    n.entries.clear();
+    n.entries.shrink_to_fit();
+
+    this->build(ranges[0].node, halves[0]);
+    this->build(ranges[1].node, halves[1]);
+}
+
+void VpTreeFrontier::rebuild() {
+    std::vector<Entry> entries;
+    entries.reserve(this->size_);
+    for (Node &node: this->nodes_) {
+        entries.insert(entries.end(), node.entries.begin(), node.entries.end());
+    }
+    this->nodes_.clear();
+    this->nodes_.emplace_back();
+    this->build(0, entries);
+    this->churn_ = 0;
+}
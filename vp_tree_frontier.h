@@ -0,0 +1,102 @@
+#ifndef RAINBOW_C_VP_TREE_FRONTIER_H
+#define RAINBOW_C_VP_TREE_FRONTIER_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "colour_bounds.h"
+#include "frontier_index.h"
+
+/// A dynamic vantage-point tree over the frontier's colours.
+///
+/// Unlike the k-d tree and grid, this never looks at RGB coordinates
+/// directly. Each internal node holds a vantage colour and splits its
+/// entries by their distance to it; nearest() prunes a subtree using only
+/// the triangle inequality against the range of distances in that subtree.
+/// That makes it work for every -d metric:
+///
+/// - colour, hue and lum are (pseudo-)metrics, so the tree is built on the
+///   difference function itself.
+/// - natural isn't a metric (its weights depend on the pair), so the tree
+///   is built on the absolute RGB distance instead, and a bound relating
+///   the two turns an RGB lower bound into a natural one.
+///
+/// Leaves are buckets of up to kLeafSize entries, split around a median
+/// distance when they overflow; one whose entries are all the same distance
+/// from every vantage waits until it has doubled before trying again.
+/// Removals leave distance ranges loose, so the tree is rebuilt after
+/// O(size) updates, like KdTreeFrontier.
+class VpTreeFrontier : public FrontierIndex {
+public:
+    explicit VpTreeFrontier(float (*difference_function)(const Colour &, const Colour &));
+
+    void insert(std::size_t slot, const Point &point, const Colour &colour) override;
+
+    void remove(std::size_t slot) override;
+
+    void move(std::size_t from, std::size_t to) override;
+
+    std::size_t nearest(const Colour &colour, float approximation) override;
+
+private:
+    static constexpr std::size_t kLeafSize = 16;
+
+    struct Entry {
+        Colour colour;
+        std::uint32_t slot;
+    };
+
+    struct Child {
+        int node = -1;
+        // Range of vantage distances of everything ever inserted below this
+        // child since the last rebuild. Never shrinks, so it stays a valid
+        // (if loose) bound after removals.
+        float lo = std::numeric_limits<float>::max();
+        float hi = 0.0f;
+    };
+
+    struct Node {
+        bool leaf = true;
+        Colour vantage;
+        // Entries closer to the vantage than `radius` go to children[0].
+        float radius = 0.0f;
+        Child children[2];
+        int parent = -1;
+        // Live entries in this subtree; empty subtrees are skipped.
+        std::size_t count = 0;
+        // Only populated for leaves.
+        std::vector<Entry> entries;
+        // A leaf is split once it holds more entries than this: kLeafSize,
+        // or twice what it held when it last couldn't be split.
+        std::size_t split_at = kLeafSize;
+    };
+
+    struct Location {
+        int node = -1;
+        int position = -1;
+    };
+
+    float (*difference_function_)(const Colour &, const Colour &);
+
+    // The metric the tree is built on, and how its bounds carry over to
+    // difference_function_.
+    TriangleBound triangle_;
+
+    std::vector<Node> nodes_;
+    std::vector<Location> locations_;
+    std::size_t size_ = 0;
+    std::size_t churn_ = 0;
+
+    struct Pending {
+        int node;
+        float bound;
+    };
+    std::vector<Pending> stack_;
+
+    void build(int node, std::vector<Entry> &entries);
+
+    void rebuild();
+};
+
+#endif //RAINBOW_C_VP_TREE_FRONTIER_H
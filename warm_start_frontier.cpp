@@ -0,0 +1,110 @@
+#include "warm_start_frontier.h"
+
+#include <algorithm>
+#include <limits>
+
+WarmStartFrontier::WarmStartFrontier(float (*difference_function)(const Colour &, const Colour &))
+    : difference_function_(difference_function),
+      triangle_(TriangleBound::forMetric(difference_function)) {
+}
+
+void WarmStartFrontier::insert(std::size_t slot, const Point &, const Colour &colour) {
+    this->place(slot, colour);
+}
+
+void WarmStartFrontier::place(std::size_t slot, const Colour &colour) {
+    if (slot >= this->colours_.size()) {
+        this->colours_.resize(slot + 1);
+        this->live_.resize(slot + 1, 0);
+        this->chunks_.resize(slot / kChunkSize + 1);
+    }
+    this->colours_[slot] = colour;
+    this->live_[slot] = 1;
+    this->size_ = std::max(this->size_, slot + 1);
+    this->addToChunk(slot);
+}
+
+void WarmStartFrontier::remove(std::size_t slot) {
+    // Nothing to do for the chunk: losing an edge can't lower its minimum.
+    this->live_[slot] = 0;
+    while (this->size_ > 0 && !this->live_[this->size_ - 1]) {
+        --this->size_;
+    }
+}
+
+void WarmStartFrontier::move(std::size_t from, std::size_t to) {
+    const Colour colour = this->colours_[from];
+    this->remove(from);
+    this->place(to, colour);
+}
+
+void WarmStartFrontier::addToChunk(std::size_t slot) {
+    Chunk &chunk = this->chunks_[slot / kChunkSize];
+    if (chunk.cached) {
+        chunk.min_distance = std::min(chunk.min_distance,
+                                      this->triangle_.distance(chunk.query, this->colours_[slot]));
+    }
+}
+
+void WarmStartFrontier::scanChunk(std::size_t chunk, const Colour &colour, float &best_diff,
+                                  std::size_t &best_slot) {
+    const bool same_metric = this->triangle_.distance == this->difference_function_;
+    const std::size_t end = std::min(this->size_, (chunk + 1) * kChunkSize);
+    float min_distance = std::numeric_limits<float>::max();
+    for (std::size_t slot = chunk * kChunkSize; slot < end; ++slot) {
+        if (!this->live_[slot]) {
+            continue;
+        }
+        const float diff = this->difference_function_(colour, this->colours_[slot]);
+        // Slots are visited in increasing order, so a tie never displaces
+        // an earlier slot from this chunk; it can only beat a later chunk's.
+        if (diff < best_diff || (diff == best_diff && slot < best_slot)) {
+            best_diff = diff;
+            best_slot = slot;
+        }
+        min_distance = std::min(min_distance,
+                                same_metric ? diff : this->triangle_.distance(colour, this->colours_[slot]));
+    }
+    Chunk &c = this->chunks_[chunk];
+    c.cached = true;
+    c.scanned_at = this->queries_;
+    c.query = colour;
+    c.min_distance = min_distance;
+}
+
+std::size_t WarmStartFrontier::nearest(const Colour &colour, float approximation) {
+    const float scale = 1.0f + approximation;
+    float best_diff = std::numeric_limits<float>::max();
+    std::size_t best_slot = std::numeric_limits<std::size_t>::max();
+
+    const std::size_t num_chunks = (this->size_ + kChunkSize - 1) / kChunkSize;
+
+    // Warm start: the previous winner's chunk, plus any never-scanned chunk.
+    // They set a tight best_diff before the cached chunks are tested.
+    ++this->queries_;
+    const std::size_t warm_chunk = this->last_winner_ / kChunkSize;
+    for (std::size_t c = 0; c < num_chunks; ++c) {
+        if (c == warm_chunk || !this->chunks_[c].cached) {
+            this->scanChunk(c, colour, best_diff, best_slot);
+        }
+    }
+
+    for (std::size_t c = 0; c < num_chunks; ++c) {
+        const Chunk &chunk = this->chunks_[c];
+        if (chunk.scanned_at == this->queries_) {
+            continue;
+        }
+        // Nothing in the chunk is closer to the old query than
+        // min_distance, so nothing is closer to this one than
+        // min_distance - distance(old query, this one).
+        const float lower = std::max(0.0f, chunk.min_distance - this->triangle_.distance(colour, chunk.query));
+        // Strictly greater: an equal bound could still hide a lower-slot tie.
+        if (this->triangle_.bound(lower) * scale > best_diff) {
+            continue;
+        }
+        this->scanChunk(c, colour, best_diff, best_slot);
+    }
+
+    this->last_winner_ = best_slot;
+    return best_slot;
+}
@@ -0,0 +1,78 @@
+#ifndef RAINBOW_C_WARM_START_FRONTIER_H
+#define RAINBOW_C_WARM_START_FRONTIER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "colour_bounds.h"
+#include "frontier_index.h"
+
+/// A chunked scan that exploits how little the colour changes from one
+/// placement to the next on a sorted palette.
+///
+/// Edges are kept in slot order and grouped into chunks of kChunkSize slots.
+/// Each chunk caches the smallest distance from its edges to the query it
+/// was last scanned for. By the triangle inequality, a later query q' can't
+/// get closer to that chunk than (cached minimum - distance(q, q')), so when
+/// consecutive queries are nearly identical most chunks are skipped without
+/// looking at a single edge.
+///
+/// Each query starts warm: the chunk holding the previous winner, and any
+/// chunk that has never been scanned, are searched first, which sets a tight
+/// bound before the cached chunks are tested against it. The caches aren't
+/// thrown away when the frontier changes: a removal can only raise a
+/// chunk's minimum, so its cached value stays a valid bound, and an insert
+/// just folds the new edge's distance into its chunk's cache.
+class WarmStartFrontier : public FrontierIndex {
+public:
+    explicit WarmStartFrontier(float (*difference_function)(const Colour &, const Colour &));
+
+    void insert(std::size_t slot, const Point &point, const Colour &colour) override;
+
+    void remove(std::size_t slot) override;
+
+    void move(std::size_t from, std::size_t to) override;
+
+    std::size_t nearest(const Colour &colour, float approximation) override;
+
+private:
+    static constexpr std::size_t kChunkSize = 256;
+
+    struct Chunk {
+        // Whether `query` and `min_distance` have been set by a scan.
+        bool cached = false;
+        // Value of queries_ when last scanned.
+        std::size_t scanned_at = 0;
+        Colour query;
+        // Lower bound on the distance (in triangle_'s metric) from `query`
+        // to every edge in the chunk.
+        float min_distance = 0.0f;
+    };
+
+    float (*difference_function_)(const Colour &, const Colour &);
+    TriangleBound triangle_;
+
+    // Colour of the edge at each slot, and whether the slot is in use.
+    // Slots at or above size_ are never live.
+    std::vector<Colour> colours_;
+    std::vector<std::uint8_t> live_;
+    std::size_t size_ = 0;
+    std::vector<Chunk> chunks_;
+
+    // Slot returned by the previous nearest() call.
+    std::size_t last_winner_ = 0;
+    // Number of nearest() calls so far.
+    std::size_t queries_ = 0;
+
+    /// Stores `colour` in the free `slot`, for insert() and move().
+    void place(std::size_t slot, const Colour &colour);
+
+    /// Folds an edge newly placed in `slot` into its chunk's cache.
+    void addToChunk(std::size_t slot);
+
+    /// Scans every live edge in `chunk`, updating the running best and
+    /// re-caching the chunk against `colour`.
+    void scanChunk(std::size_t chunk, const Colour &colour, float &best_diff, std::size_t &best_slot);
+};
+
+#endif //RAINBOW_C_WARM_START_FRONTIER_H